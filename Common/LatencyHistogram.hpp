@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace Simple {
+    /// Log-linear (HDR-style) latency histogram in nanoseconds, every power of two is split into
+    /// sub_count buckets, which keeps the relative error below 1/sub_count over the whole range.
+    /// Recording takes no locks; one writer at a time, any number of concurrent readers.
+    class LatencyHistogram {
+    public:
+        static constexpr const unsigned sub_bits = 3;
+        static constexpr const size_t sub_count = size_t(1) << sub_bits;
+        static constexpr const size_t buckets = (64 - sub_bits + 1) * sub_count;
+
+        [[nodiscard]] static constexpr size_t bucket_of(uint64_t value) {
+            if (value < sub_count) return value;
+            const unsigned shift = std::bit_width(value) - 1 - sub_bits;
+            return (shift + 1) * sub_count + ((value >> shift) & (sub_count - 1));
+        }
+
+        /// Largest value that falls into the bucket.
+        [[nodiscard]] static constexpr uint64_t bucket_max(size_t bucket) {
+            if (bucket < sub_count) return bucket;
+            const size_t shift = bucket / sub_count - 1;
+            return ((sub_count + bucket % sub_count + 1) << shift) - 1;
+        }
+
+        struct Snapshot {
+            std::array<uint64_t, buckets> counts{};
+
+            [[nodiscard]] uint64_t count() const {
+                uint64_t total = 0;
+                for (uint64_t c : counts) total += c;
+                return total;
+            }
+
+            /// Upper bound of the value below which the given fraction (0..1] of samples falls, 0 if empty.
+            [[nodiscard]] uint64_t percentile(double fraction) const {
+                const uint64_t total = count();
+                if (!total) return 0;
+                const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * total + 0.5));
+                uint64_t seen = 0;
+                for (size_t bucket = 0; bucket < buckets; ++bucket)
+                    if ((seen += counts[bucket]) >= rank) return bucket_max(bucket);
+                return bucket_max(buckets - 1);
+            }
+
+            Snapshot & operator+= (const Snapshot & other) {
+                for (size_t bucket = 0; bucket < buckets; ++bucket) counts[bucket] += other.counts[bucket];
+                return *this;
+            }
+        };
+
+        void record(uint64_t nanos, uint64_t times = 1) {
+            auto & counter = counts_[bucket_of(nanos)];
+            counter.store(counter.load(std::memory_order_relaxed) + times, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] Snapshot snapshot() const {
+            Snapshot result;
+            for (size_t bucket = 0; bucket < buckets; ++bucket)
+                result.counts[bucket] = counts_[bucket].load(std::memory_order_relaxed);
+            return result;
+        }
+
+    private:
+        std::array<std::atomic_uint64_t, buckets> counts_{};
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace Simple {
+    /// Fork-join pool running loops of independent, non-throwing iterations. run() splits the index range
+    /// into one part per thread (the caller takes part too), every thread works its own part from the front
+    /// in small chunks and, once done, steals the back half of a part still in progress.
+    /// One loop runs at a time: run() called while the pool is busy, e.g. from inside a loop body,
+    /// executes its loop serially on the calling thread.
+    class WorkStealingPool {
+        using Task = void (*) (const void *, size_t);
+
+        // Remaining [begin, end) of a part packed in one word, owner and thieves claim from it with a CAS
+        struct alignas(64) Range {
+            std::atomic_uint64_t bounds{0};
+        };
+        [[nodiscard]] static uint64_t pack (uint64_t begin, uint64_t end) { return begin << 32 | end; }
+
+        const size_t parts_;
+        const std::unique_ptr<Range[]> ranges_;
+        // The loop being run, only read by a thread after it claimed some of its iterations
+        Task task_;
+        const void * context_;
+        std::atomic_uint64_t grain_; // iterations an owner claims at once
+        alignas(64) std::atomic_size_t pending_;  // iterations not finished yet
+        alignas(64) std::atomic_uint32_t epoch_; // bumped per loop, idle workers wait on it
+        std::mutex run_mtx_;
+        std::vector<std::jthread> workers_;
+
+        // Takes the next chunk of the own part, failing that, the back half of another part. The loot is not
+        // put up for stealing again: a thread still busy with the previous loop could then lose it to run().
+        [[nodiscard]] bool claim (size_t self, uint64_t & begin, uint64_t & end) {
+            for (size_t round = 0; round < parts_; ++round) {
+                Range & range = ranges_[(self + round) % parts_];
+                uint64_t bounds = range.bounds.load(std::memory_order_acquire);
+                for (;;) {
+                    begin = bounds >> 32;
+                    end = bounds & UINT32_MAX;
+                    if (begin >= end) break;
+                    const uint64_t split = round ? begin + (end - begin) / 2
+                                                 : std::min(end, begin + grain_.load(std::memory_order_relaxed));
+                    const uint64_t rest = round ? pack(begin, split) : pack(split, end);
+                    if (range.bounds.compare_exchange_weak(bounds, rest, std::memory_order_acq_rel)) {
+                        if (round) begin = split;
+                        else end = split;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void participate (size_t self) {
+            uint64_t begin, end;
+            while (claim(self, begin, end)) {
+                for (uint64_t i = begin; i < end; ++i) task_(context_, i);
+                if (pending_.fetch_sub(end - begin, std::memory_order_acq_rel) == end - begin) pending_.notify_all();
+            }
+        }
+
+        void work (const std::stop_token & stop, size_t self) {
+            uint32_t seen = 0;
+            for (;;) {
+                epoch_.wait(seen, std::memory_order_acquire);
+                if (stop.stop_requested()) return;
+                seen = epoch_.load(std::memory_order_acquire);
+                participate(self);
+            }
+        }
+
+    public:
+        /// Starts `workers` threads, by default one less than the hardware threads as the caller helps out.
+        explicit WorkStealingPool (size_t workers = std::max(std::thread::hardware_concurrency(), 1u) - 1)
+            : parts_(workers + 1), ranges_(new Range[workers + 1]), task_(nullptr), context_(nullptr), grain_(1),
+              pending_(0), epoch_(0), run_mtx_(), workers_() {
+            workers_.reserve(workers);
+            for (size_t worker = 0; worker < workers; ++worker)
+                workers_.emplace_back([this, worker] (std::stop_token stop) { work(stop, worker); });
+        }
+        WorkStealingPool (const WorkStealingPool&)            = delete;
+        WorkStealingPool& operator= (const WorkStealingPool&) = delete;
+
+        ~WorkStealingPool () {
+            for (auto & worker : workers_) worker.request_stop();
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_all();
+            workers_.clear();
+        }
+
+        /// Process wide pool shared by everything that does not bring its own.
+        [[nodiscard]] static WorkStealingPool & shared () {
+            static WorkStealingPool pool;
+            return pool;
+        }
+
+        /// Calls body(i) for every i in [0, count) spread over the pool, returns once all calls returned.
+        /// body must not throw.
+        template<class Body>
+        void run (size_t count, const Body & body) {
+            std::unique_lock lock(run_mtx_, std::try_to_lock);
+            if (!lock || workers_.empty() || count < 2 || count > UINT32_MAX) {
+                for (size_t i = 0; i < count; ++i) body(i);
+                return;
+            }
+            task_ = [] (const void * context, size_t i) { (*static_cast<const Body*>(context))(i); };
+            context_ = &body;
+            grain_.store(std::max<uint64_t>(count / (parts_ * 8), 1), std::memory_order_relaxed);
+            pending_.store(count, std::memory_order_relaxed);
+            for (size_t part = 0; part < parts_; ++part)
+                ranges_[part].bounds.store(pack(count * part / parts_, count * (part + 1) / parts_), std::memory_order_release);
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_all();
+            participate(parts_ - 1);
+            for (size_t left; (left = pending_.load(std::memory_order_acquire)); )
+                pending_.wait(left, std::memory_order_acquire);
+        }
+
+        [[nodiscard]] size_t workers () const {
+            return workers_.size();
+        }
+    };
+}
@@ -0,0 +1,162 @@
+#ifndef DUMMY_EPOCHDOMAIN_HPP
+#define DUMMY_EPOCHDOMAIN_HPP
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "ReclaimDomain.hpp"
+
+struct EpochDefaultTag {};
+
+// Epoch based reclamation after Fraser. A reader announces the global
+// epoch once when it enters a critical section and clears it on leaving,
+// reads in between are plain loads. A writer tags every retired object
+// with the epoch it was retired in, the epoch only advances once every
+// thread inside a critical section has seen the current one, so an
+// object is unreachable for everybody two epochs later.
+//
+// Reads are cheaper than with hazard pointers, especially when a guard
+// covers many of them, but one reader stalled inside a critical section
+// keeps everything retired after it from being freed. HazardDomain and
+// EpochDomain have the same interface and can be swapped as a policy.
+template<class Tag = EpochDefaultTag>
+class EpochDomain {
+    static constexpr uint64_t kQuiescent = 0;
+
+    struct Record {
+        // Epoch the owner entered its critical section at, or kQuiescent
+        std::atomic_uint64_t epoch_{kQuiescent};
+        std::atomic_bool active_{true};
+        Record * pNext_ = nullptr;
+    };
+    struct Retired {
+        void * ptr;
+        void (*deleter)(void *);
+        uint64_t epoch;
+    };
+    struct ThreadState;
+    using Shared = ReclaimDomain<Record, Retired, ThreadState>;
+
+    static constexpr size_t kBatch = 64;
+
+    static inline std::atomic_uint64_t epoch_{1};
+
+    struct ThreadState {
+        Record * rec = Shared::AcquireRecord();
+        size_t nesting = 0;
+        std::vector<Retired> limbo;
+        // Collect again once the limbo reaches this, twice what a stalled epoch left behind
+        size_t collectAt = kBatch;
+        ~ThreadState() {
+            Collect(*this);
+            Shared::Orphan(limbo);
+            rec->epoch_.store(kQuiescent);
+            rec->active_.store(false);
+            Shared::alive() = false;
+        }
+    };
+
+    static void Announce(Record * rec) {
+        rec->epoch_.store(epoch_.load());
+    }
+
+    // Moves the global epoch on if every thread in a critical section has seen the current one
+    static void TryAdvance() {
+        uint64_t epoch = epoch_.load();
+        for (Record * p = Shared::pHead_.load(); p; p = p->pNext_) {
+            const uint64_t seen = p->epoch_.load();
+            if (seen != kQuiescent && seen != epoch) return;
+        }
+        epoch_.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    static void Collect(ThreadState &local) {
+        Shared::AdoptOrphans(local.limbo);
+        TryAdvance();
+        const uint64_t epoch = epoch_.load();
+        Shared::Reclaim(local.limbo, [epoch] (const Retired &r) { return r.epoch + 2 > epoch; });
+        local.collectAt = std::max(kBatch, 2 * local.limbo.size());
+    }
+
+public:
+    // Keeps the calling thread inside a critical section for its lifetime,
+    // everything read meanwhile stays allocated. Guards nest; a guard may
+    // be moved, but must be destroyed on the thread that created it.
+    class Guard {
+        ThreadState * local_ = nullptr;
+        Record * own_ = nullptr; // borrowed while the thread's state is torn down
+    public:
+        Guard() {
+            if (Shared::alive()) {
+                local_ = &Shared::Local();
+                if (local_->nesting++ == 0) Announce(local_->rec);
+            } else {
+                own_ = Shared::AcquireRecord();
+                Announce(own_);
+            }
+        }
+        Guard(Guard &&other) noexcept
+            : local_(std::exchange(other.local_, nullptr)), own_(std::exchange(other.own_, nullptr)) {}
+        Guard& operator=(Guard &&other) noexcept {
+            std::swap(local_, other.local_);
+            std::swap(own_, other.own_);
+            return *this;
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard() {
+            if (local_ && --local_->nesting == 0) local_->rec->epoch_.store(kQuiescent, std::memory_order_release);
+            if (own_) {
+                own_->epoch_.store(kQuiescent, std::memory_order_release);
+                own_->active_.store(false);
+            }
+        }
+
+        // Protection covers the guard's lifetime, a plain load suffices
+        template<class T>
+        T * Protect(const std::atomic<T*> &src) {
+            return src.load();
+        }
+
+        // No-ops, kept for interface parity with HazardDomain::Guard
+        void Set(const void *) {}
+        void Clear() {}
+    };
+
+    // Frees ptr with the deleter once every thread has left the critical
+    // sections it might have been read in. The deleter must be stateless.
+    template<class T, class Deleter = std::default_delete<T>>
+    static void Retire(T * ptr, Deleter = Deleter()) {
+        const Retired retired{ptr, Shared::template Thunk<T, Deleter>(), epoch_.load()};
+        Shared::unreclaimed_.fetch_add(1, std::memory_order_relaxed);
+        if (!Shared::alive()) return Shared::Orphan(retired); // retiring from another thread local's destructor
+        ThreadState &local = Shared::Local();
+        local.limbo.push_back(retired);
+        if (local.limbo.size() >= local.collectAt) Collect(local);
+    }
+
+    // Advances the epoch if possible and frees this thread's retired objects that became unreachable
+    static void Scan() {
+        if (Shared::alive()) Collect(Shared::Local());
+    }
+
+    // Objects retired by this thread and not freed yet
+    static size_t Pending() {
+        return Shared::alive() ? Shared::Local().limbo.size() : 0;
+    }
+
+    // Objects retired by any thread and not freed yet
+    static size_t Unreclaimed() {
+        return Shared::unreclaimed_.load(std::memory_order_relaxed);
+    }
+
+    // Number of thread records ever created in the domain
+    static size_t Records() {
+        return Shared::listLen_.load();
+    }
+};
+
+#endif //DUMMY_EPOCHDOMAIN_HPP
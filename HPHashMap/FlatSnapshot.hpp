@@ -0,0 +1,137 @@
+#ifndef DUMMY_FLATSNAPSHOT_HPP
+#define DUMMY_FLATSNAPSHOT_HPP
+
+#include <bit>
+#include <span>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <limits>
+#include <cstddef>
+#include <optional>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Immutable int to int map laid out for reading: sorted keys in one
+// array, the values in another behind it, all in a single allocation.
+// A lookup binary searches the keys down to a block of kBlock and counts
+// the keys below the one looked for with SIMD compares, touching a few
+// cache lines of keys and one of values. Every change builds a new
+// snapshot in O(n), which is what a write-rarely map can afford.
+class FlatSnapshot {
+    // The keys are followed by kBlock sentinels, so a block read never leaves the array
+    static constexpr size_t kBlock = 16;
+    static constexpr int kSentinel = std::numeric_limits<int>::max();
+
+    size_t size_;
+    std::unique_ptr<int[]> data_;
+
+    explicit FlatSnapshot(size_t size)
+        : size_(size), data_(new int[size + kBlock + size]) {
+        std::fill_n(Keys() + size_, kBlock, kSentinel);
+    }
+
+    int * Keys() const { return data_.get(); }
+    int * Values() const { return data_.get() + size_ + kBlock; }
+
+    // Number of keys below k among the kBlock keys at block, the sentinels never count
+    static size_t CountBelow(const int * block, int k) {
+#if defined(__SSE2__)
+        const __m128i key = _mm_set1_epi32(k);
+        unsigned mask = 0;
+        for (size_t i = 0; i < kBlock / 4; ++i) {
+            const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 4 * i));
+            mask |= static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(keys, key)))) << (4 * i);
+        }
+        return std::popcount(mask);
+#else
+        size_t count = 0;
+        for (size_t i = 0; i < kBlock; ++i) count += block[i] < k;
+        return count;
+#endif
+    }
+
+public:
+    FlatSnapshot() : FlatSnapshot(size_t(0)) {}
+    FlatSnapshot(const FlatSnapshot&) = delete;
+    FlatSnapshot& operator=(const FlatSnapshot&) = delete;
+
+    // Index of the first key not below k, Size() if there is none
+    size_t LowerBound(int k) const {
+        const int * base = Keys();
+        size_t len = size_;
+        // Branch free halving keeps the answer within [base, base + len]
+        while (len > kBlock) {
+            const size_t half = len / 2;
+            base = base[half] < k ? base + half : base;
+            len -= half;
+        }
+        return (base - Keys()) + CountBelow(base, k);
+    }
+
+    std::optional<int> Find(int k) const {
+        const size_t index = LowerBound(k);
+        if (index < size_ && Keys()[index] == k) return Values()[index];
+        return std::nullopt;
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    // New snapshot with k set to v
+    std::unique_ptr<FlatSnapshot> With(int k, int v) const {
+        const size_t index = LowerBound(k);
+        if (index < size_ && Keys()[index] == k) {
+            std::unique_ptr<FlatSnapshot> result(new FlatSnapshot(size_));
+            std::copy_n(Keys(), size_, result->Keys());
+            std::copy_n(Values(), size_, result->Values());
+            result->Values()[index] = v;
+            return result;
+        }
+        std::unique_ptr<FlatSnapshot> result(new FlatSnapshot(size_ + 1));
+        std::copy_n(Keys(), index, result->Keys());
+        std::copy_n(Values(), index, result->Values());
+        result->Keys()[index] = k;
+        result->Values()[index] = v;
+        std::copy(Keys() + index, Keys() + size_, result->Keys() + index + 1);
+        std::copy(Values() + index, Values() + size_, result->Values() + index + 1);
+        return result;
+    }
+
+    // New snapshot with all updates applied in one pass, a later update of a key wins over an earlier one
+    std::unique_ptr<FlatSnapshot> With(std::span<const std::pair<int, int>> updates) const {
+        if (updates.size() == 1) return With(updates[0].first, updates[0].second);
+        std::vector<std::pair<int, int>> sorted(updates.begin(), updates.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [] (const auto &a, const auto &b) { return a.first < b.first; });
+        // Keep the last update of every key
+        size_t unique = 0;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            if (i + 1 < sorted.size() && sorted[i + 1].first == sorted[i].first) continue;
+            sorted[unique++] = sorted[i];
+        }
+        sorted.resize(unique);
+        size_t added = 0;
+        for (const auto &update : sorted) added += !Find(update.first);
+        std::unique_ptr<FlatSnapshot> result(new FlatSnapshot(size_ + added));
+        // Merge the old keys with the updates
+        size_t from = 0, to = 0;
+        for (const auto &update : sorted) {
+            const size_t index = LowerBound(update.first);
+            std::copy(Keys() + from, Keys() + index, result->Keys() + to);
+            std::copy(Values() + from, Values() + index, result->Values() + to);
+            to += index - from;
+            from = index < size_ && Keys()[index] == update.first ? index + 1 : index;
+            result->Keys()[to] = update.first;
+            result->Values()[to] = update.second;
+            ++to;
+        }
+        std::copy(Keys() + from, Keys() + size_, result->Keys() + to);
+        std::copy(Values() + from, Values() + size_, result->Values() + to);
+        return result;
+    }
+};
+
+#endif //DUMMY_FLATSNAPSHOT_HPP
@@ -0,0 +1,241 @@
+#ifndef DUMMY_HPHASHMAP_HPP
+#define DUMMY_HPHASHMAP_HPP
+
+#include <bit>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <functional>
+#include "HazardPointer.hpp"
+#include "EpochDomain.hpp"
+
+// Lock-free hash map after Shalev and Shavit's split-ordered lists: all
+// entries sit in one Michael lock-free list sorted by bit-reversed hash,
+// buckets are shortcuts into it marked by dummy nodes. Doubling the bucket
+// count never moves an entry, a new bucket just gets its dummy spliced in
+// on first use. Every operation is O(1) expected and allocates at most one
+// node; removed nodes are reclaimed through the Reclaimer, hazard pointers
+// by default or EpochDomain for cheaper lookups.
+template<class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>,
+         class Reclaimer = HazardDomain<>>
+class HPHashMap {
+    // Dummy nodes have an even split-order key, entries an odd one
+    struct Node {
+        const uint64_t soKey_;
+        // Successor, the low bit marks this node as removed
+        std::atomic_uintptr_t next_;
+        explicit Node(uint64_t soKey) : soKey_(soKey), next_(0) {}
+    };
+    struct Entry : Node {
+        const K key_;
+        const V value_;
+        Entry(uint64_t soKey, const K &key, const V &value) : Node(soKey), key_(key), value_(value) {}
+    };
+
+    static constexpr uintptr_t kMark = 1;
+    static constexpr size_t kMaxLoad = 2;
+    static constexpr size_t kSegments = 48; // up to 2^47 buckets
+
+    static Node * Ptr(uintptr_t link) { return reinterpret_cast<Node*>(link & ~kMark); }
+    static bool Marked(uintptr_t link) { return link & kMark; }
+    static uintptr_t Link(Node * node, bool mark = false) { return reinterpret_cast<uintptr_t>(node) | mark; }
+
+    static uint64_t Reverse(uint64_t x) {
+        x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+        x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+        x = ((x >> 4) & 0x0f0f0f0f0f0f0f0full) | ((x & 0x0f0f0f0f0f0f0f0full) << 4);
+        x = ((x >> 8) & 0x00ff00ff00ff00ffull) | ((x & 0x00ff00ff00ff00ffull) << 8);
+        x = ((x >> 16) & 0x0000ffff0000ffffull) | ((x & 0x0000ffff0000ffffull) << 16);
+        return (x >> 32) | (x << 32);
+    }
+    static uint64_t DummyKey(size_t bucket) { return Reverse(bucket); }
+    static uint64_t EntryKey(size_t hash) { return Reverse(hash) | 1; }
+
+    // Bucket b lives in segment bit_width(b), segment s > 0 holds 2^(s-1) buckets
+    using Segment = std::atomic<Node*>;
+    std::array<std::atomic<Segment*>, kSegments> segments_{};
+    std::atomic_size_t bucketCount_;
+    std::atomic_size_t size_;
+    Hash hash_;
+    KeyEqual equal_;
+
+    static size_t SegmentOf(size_t bucket) { return std::bit_width(bucket); }
+    static size_t SegmentSize(size_t segment) { return segment ? size_t(1) << (segment - 1) : 1; }
+    static size_t OffsetOf(size_t bucket) { return bucket ? bucket - std::bit_floor(bucket) : 0; }
+
+    std::atomic<Node*> & Bucket(size_t bucket) {
+        const size_t segment = SegmentOf(bucket);
+        Segment * slots = segments_[segment].load();
+        if (!slots) {
+            auto fresh = std::make_unique<Segment[]>(SegmentSize(segment));
+            if (segments_[segment].compare_exchange_strong(slots, fresh.get())) slots = fresh.release();
+        }
+        return slots[OffsetOf(bucket)];
+    }
+
+    // The three hazard pointers of Michael's list traversal
+    class Guard {
+        std::array<typename Reclaimer::Guard, 3> hps_;
+    public:
+        void Protect(size_t i, Node * node) { hps_[i].Set(node); }
+    };
+
+    // Position of a key in the list: *prev links to cur, cur's successor is next
+    struct Window {
+        std::atomic_uintptr_t * prev;
+        Node * cur;
+        uintptr_t next;
+    };
+
+    // Michael's search from the given dummy: unlinks removed nodes on the
+    // way and stops at the entry with the key (returns true) or at the first
+    // node ordered after it. With key == nullptr it looks for the dummy soKey.
+    bool Find(Node * start, uint64_t soKey, const K * key, Guard & guard, Window & w) {
+    tryAgain:
+        w.prev = &start->next_;
+        w.cur = Ptr(w.prev->load());
+        guard.Protect(1, w.cur);
+        if (w.prev->load() != Link(w.cur)) goto tryAgain;
+        for (;;) {
+            if (!w.cur) return false;
+            w.next = w.cur->next_.load();
+            guard.Protect(0, Ptr(w.next));
+            if (w.cur->next_.load() != w.next) goto tryAgain;
+            if (w.prev->load() != Link(w.cur)) goto tryAgain;
+            if (!Marked(w.next)) {
+                const uint64_t curKey = w.cur->soKey_;
+                if (curKey > soKey) return false;
+                if (curKey == soKey && (!key || equal_(static_cast<Entry*>(w.cur)->key_, *key))) return true;
+                w.prev = &w.cur->next_;
+                guard.Protect(2, w.cur);
+            } else {
+                uintptr_t expected = Link(w.cur);
+                if (!w.prev->compare_exchange_strong(expected, Link(Ptr(w.next)))) goto tryAgain;
+                Reclaimer::Retire(static_cast<Entry*>(w.cur));
+            }
+            w.cur = Ptr(w.next);
+            guard.Protect(1, w.cur);
+        }
+    }
+
+    // Dummy node of the bucket, spliced into the list on first use
+    Node * DummyOf(size_t bucket) {
+        std::atomic<Node*> & slot = Bucket(bucket);
+        Node * dummy = slot.load();
+        if (dummy) return dummy;
+        Node * parent = DummyOf(bucket ? bucket - std::bit_floor(bucket) : 0);
+        auto fresh = std::make_unique<Node>(DummyKey(bucket));
+        Guard guard;
+        Window w;
+        for (;;) {
+            if (Find(parent, fresh->soKey_, nullptr, guard, w)) {
+                dummy = w.cur; // somebody else was faster
+                break;
+            }
+            fresh->next_.store(Link(w.cur));
+            uintptr_t expected = Link(w.cur);
+            if (w.prev->compare_exchange_strong(expected, Link(fresh.get()))) {
+                dummy = fresh.release();
+                break;
+            }
+        }
+        slot.store(dummy);
+        return dummy;
+    }
+
+    Node * StartOf(size_t hash) {
+        return DummyOf(hash & (bucketCount_.load() - 1));
+    }
+
+    void Grow() {
+        size_t buckets = bucketCount_.load();
+        if (size_.load() > buckets * kMaxLoad && buckets < (size_t(1) << (kSegments - 1)))
+            bucketCount_.compare_exchange_strong(buckets, buckets * 2);
+    }
+
+public:
+    explicit HPHashMap(size_t buckets = 16, const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual())
+        : bucketCount_(std::bit_ceil(std::max<size_t>(buckets, 1))), size_(0), hash_(hash), equal_(equal) {
+        Bucket(0).store(new Node(DummyKey(0)));
+    }
+    HPHashMap(const HPHashMap&) = delete;
+    HPHashMap& operator=(const HPHashMap&) = delete;
+
+    // No thread may use the map while it is being destroyed
+    ~HPHashMap() {
+        Node * node = Bucket(0).load();
+        while (node) {
+            Node * next = Ptr(node->next_.load());
+            if (node->soKey_ & 1) delete static_cast<Entry*>(node);
+            else delete node;
+            node = next;
+        }
+        for (auto & segment : segments_) delete[] segment.load();
+    }
+
+    // Inserts or replaces the value, returns true if the key was new
+    bool Update(const K &k, const V &v) {
+        const size_t hash = hash_(k);
+        const uint64_t soKey = EntryKey(hash);
+        auto entry = std::make_unique<Entry>(soKey, k, v);
+        Node * start = StartOf(hash);
+        Guard guard;
+        Window w;
+        for (;;) {
+            if (Find(start, soKey, &k, guard, w)) {
+                // Replace in one step: mark the old entry with the new one as its successor
+                entry->next_.store(Link(Ptr(w.next)));
+                if (!w.cur->next_.compare_exchange_strong(w.next, Link(entry.get(), true))) continue;
+                // Once published the entry may be replaced and reclaimed any time, don't touch it
+                uintptr_t expected = Link(w.cur);
+                if (w.prev->compare_exchange_strong(expected, Link(entry.release()))) Reclaimer::Retire(static_cast<Entry*>(w.cur));
+                else Find(start, soKey, &k, guard, w); // let a traversal unlink it
+                return false;
+            }
+            entry->next_.store(Link(w.cur));
+            uintptr_t expected = Link(w.cur);
+            if (w.prev->compare_exchange_strong(expected, Link(entry.get()))) {
+                entry.release();
+                size_.fetch_add(1);
+                Grow();
+                return true;
+            }
+        }
+    }
+
+    // Removes the key, returns false if it was not there
+    bool Erase(const K &k) {
+        const size_t hash = hash_(k);
+        const uint64_t soKey = EntryKey(hash);
+        Node * start = StartOf(hash);
+        Guard guard;
+        Window w;
+        for (;;) {
+            if (!Find(start, soKey, &k, guard, w)) return false;
+            if (!w.cur->next_.compare_exchange_strong(w.next, w.next | kMark)) continue;
+            size_.fetch_sub(1);
+            uintptr_t expected = Link(w.cur);
+            if (w.prev->compare_exchange_strong(expected, Link(Ptr(w.next)))) Reclaimer::Retire(static_cast<Entry*>(w.cur));
+            else Find(start, soKey, &k, guard, w);
+            return true;
+        }
+    }
+
+    std::optional<V> Lookup(const K &k) {
+        const size_t hash = hash_(k);
+        Guard guard;
+        Window w;
+        if (!Find(StartOf(hash), EntryKey(hash), &k, guard, w)) return std::nullopt;
+        return static_cast<Entry*>(w.cur)->value_;
+    }
+
+    // Number of entries, exact only while no writer runs
+    size_t Size() const {
+        return size_.load();
+    }
+};
+
+#endif //DUMMY_HPHASHMAP_HPP
@@ -5,136 +5,164 @@
 #ifndef DUMMY_HAZARDPOINTER_HPP
 #define DUMMY_HAZARDPOINTER_HPP
 
-#include <map>
 #include <atomic>
 #include <thread>
 #include <vector>
+#include <memory>
+#include <utility>
 #include <algorithm>
+#include "ReclaimDomain.hpp"
 
-class HPRecType {
-    HPRecType * pNext_;
-    // State of the current HP record
-    std::atomic_bool active_;
-    // Global header of the HP list
-    static std::atomic<HPRecType*> pHead_;
-    // The length of the list
-    static std::atomic_size_t listLen_;
-public:
-    // Can be used by the thread
-    // that acquired it
-    void *pHazard_;
+struct HazardDefaultTag {};
+
+// Hazard pointer domain after Maged Michael. A reader publishes the
+// pointer it is about to dereference in a hazard record, a writer retires
+// unlinked objects and frees them once no record refers to them.
+// Every Tag gets a domain of its own, scans only look at its records.
+//
+// Each thread keeps a few records cached, so taking a Guard and
+// protecting a pointer costs two stores and a load, no CAS. Retired
+// objects are scanned in batches proportional to the number of records,
+// which amortises a scan to O(1) per retired object. A thread exiting
+// gives its records back and hands whatever it could not free yet to the
+// next thread that scans.
+template<class Tag = HazardDefaultTag>
+class HazardDomain {
+    struct Record {
+        std::atomic<void*> pHazard_{nullptr};
+        std::atomic_bool active_{true};
+        Record * pNext_ = nullptr;
+    };
+    struct Retired {
+        void * ptr;
+        void (*deleter)(void *);
+    };
+    struct ThreadState;
+    using Shared = ReclaimDomain<Record, Retired, ThreadState>;
+
+    static constexpr size_t kSpareRecords = 8;
+    static constexpr size_t kMinBatch = 64;
 
-    static HPRecType * Head() {
-        return pHead_.load();
+    struct ThreadState {
+        std::vector<Record*> spare;
+        std::vector<Retired> rlist;
+        std::vector<void*> hazards; // scratch for Scan
+        ~ThreadState() {
+            Scan(*this);
+            Shared::Orphan(rlist);
+            for (Record * rec : spare) rec->active_.store(false);
+            Shared::alive() = false;
+        }
+    };
+
+    static Record * Acquire() {
+        if (Shared::alive()) {
+            auto &spare = Shared::Local().spare;
+            if (!spare.empty()) {
+                Record * rec = spare.back();
+                spare.pop_back();
+                return rec;
+            }
+        }
+        return Shared::AcquireRecord();
     }
 
-    // Acquires one hazard pointer
-    static HPRecType * Acquire() {
-        // Try to reuse a retired HP record
-        HPRecType * p = pHead_.load();
-        for (; p; p = p->pNext_) {
-            bool inactive = false;
-            if (p->active_.load() || !p->active_.compare_exchange_weak(inactive, true))
-                continue;
-            // Got one!
-            return p;
+    static void Release(Record * rec) {
+        rec->pHazard_.store(nullptr, std::memory_order_release);
+        if (Shared::alive()) {
+            auto &spare = Shared::Local().spare;
+            if (spare.size() < kSpareRecords) {
+                spare.push_back(rec);
+                return;
+            }
         }
-        // Increment the list length
-        size_t oldLen;
-        do {
-            oldLen = listLen_.load();
-        } while (!listLen_.compare_exchange_weak(oldLen, oldLen + 1));
-        // Allocate a new one
-        p = new HPRecType;
-        p->active_.store(1);
-        p->pHazard_ = 0;
-        // Push it to the front
-        HPRecType * old;
-        do {
-            old = pHead_.load();
-            p->pNext_ = old;
-        } while (!pHead_.compare_exchange_weak(old, p));
-        return p;
+        rec->active_.store(false);
     }
-    // Releases a hazard pointer
-    static void Release(HPRecType* p) {
-        p->pHazard_ = 0;
-        p->active_.store(false);
+
+    static void Scan(ThreadState &local) {
+        Shared::AdoptOrphans(local.rlist);
+        // Stage 1: collect the published hazard pointers, seq_cst loads pair with the readers' stores
+        local.hazards.clear();
+        for (Record * p = Shared::pHead_.load(); p; p = p->pNext_)
+            if (void * hazard = p->pHazard_.load()) local.hazards.push_back(hazard);
+        // Stage 2: sort them
+        std::sort(local.hazards.begin(), local.hazards.end(), std::less<>());
+        // Stage 3: free what nobody protects
+        Shared::Reclaim(local.rlist, [&local] (const Retired &r) {
+            return std::binary_search(local.hazards.begin(), local.hazards.end(), r.ptr, std::less<>());
+        });
     }
-    friend void Scan(HPRecType * head);
-    friend class WRRMMap;
-};
 
-std::atomic<HPRecType*> HPRecType::pHead_ = 0;
-std::atomic_size_t HPRecType::listLen_ = 0;
+public:
+    // Owns one hazard record for its lifetime, movable between threads
+    class Guard {
+        Record * rec_;
+    public:
+        Guard() : rec_(Acquire()) {}
+        Guard(Guard &&other) noexcept : rec_(std::exchange(other.rec_, nullptr)) {}
+        Guard& operator=(Guard &&other) noexcept {
+            std::swap(rec_, other.rec_);
+            return *this;
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard() {
+            if (rec_) Release(rec_);
+        }
 
-thread_local std::vector<std::map<int, int>*> rlist;
+        // Loads the pointer and keeps it protected until the next Protect, Set or Clear
+        template<class T>
+        T * Protect(const std::atomic<T*> &src) {
+            T * ptr = src.load(std::memory_order_relaxed);
+            for (;;) {
+                rec_->pHazard_.store(ptr);
+                T * current = src.load();
+                if (current == ptr) return ptr;
+                ptr = current;
+            }
+        }
 
-class WRRMMap {
-    std::atomic<std::map<int,int>*> pMap_ = new std::map<int,int>();
+        // Publishes ptr, the caller validates it is still reachable afterwards
+        void Set(const void * ptr) {
+            rec_->pHazard_.store(const_cast<void*>(ptr));
+        }
 
-    static void Retire(std::map<int, int> *pOld) {
-        // Put it in the retired list
-        rlist.push_back(pOld);
-        if (rlist.size() >= 2) {
-            Scan(HPRecType::Head());
+        void Clear() {
+            rec_->pHazard_.store(nullptr, std::memory_order_release);
         }
+    };
+
+    // Frees ptr with the deleter once no hazard pointer refers to it.
+    // The deleter type is part of the retired entry, it must be stateless.
+    template<class T, class Deleter = std::default_delete<T>>
+    static void Retire(T * ptr, Deleter = Deleter()) {
+        const Retired retired{ptr, Shared::template Thunk<T, Deleter>()};
+        Shared::unreclaimed_.fetch_add(1, std::memory_order_relaxed);
+        if (!Shared::alive()) return Shared::Orphan(retired); // retiring from another thread local's destructor
+        ThreadState &local = Shared::Local();
+        local.rlist.push_back(retired);
+        if (local.rlist.size() >= kMinBatch + 2 * Shared::listLen_.load(std::memory_order_relaxed)) Scan(local);
     }
-public:
-    void Update(const int &k, const int &v) {
-        std::map<int, int> * pNew = 0;
-        std::map<int, int> * pOld;
-        do {
-            pOld = pMap_;
-            delete pNew;
-            pNew = new std::map<int,int>(*pOld);
-            (*pNew)[k] = v;
-        } while (!pMap_.compare_exchange_weak(pOld, pNew));
-        Retire(pOld);
+
+    // Frees every object retired by this thread that is not protected right now
+    static void Scan() {
+        if (Shared::alive()) Scan(Shared::Local());
     }
 
-    int Lookup(const int &k) {
-        HPRecType * pRec = HPRecType::Acquire();
-        std::map<int, int> * ptr;
-        do {
-            ptr = pMap_;
-            pRec->pHazard_ = ptr;
-        } while (pMap_ != ptr);
-        // Save Willy
-        int result = (*ptr)[k];
-        // pRec can be released now
-        // because it's not used anymore
-        HPRecType::Release(pRec);
-        return result;
+    // Objects retired by this thread and not freed yet
+    static size_t Pending() {
+        return Shared::alive() ? Shared::Local().rlist.size() : 0;
     }
-};
 
-void Scan(HPRecType * head) {
-    // Stage 1: Scan hazard pointers list
-    // collecting all non-null pointers
-    std::vector<void*> hp;
-    while (head) {
-        void * p = head->pHazard_;
-        if (p) hp.push_back(p);
-        head = head->pNext_;
+    // Objects retired by any thread and not freed yet
+    static size_t Unreclaimed() {
+        return Shared::unreclaimed_.load(std::memory_order_relaxed);
     }
-    // Stage 2: sort the hazard pointers
-    std::sort(hp.begin(), hp.end(), std::less<>());
-    // Stage 3: Search for them!
-    auto i = rlist.begin();
-    while (i != rlist.end()) { // cppcheck-suppress [invalidContainer]
-        if (!std::binary_search(hp.begin(), hp.end(), *i)) {
-            // Aha!
-            delete *i;
-            if (&*i != &rlist.back()) {
-                *i = rlist.back();
-            }
-            // Following is safe - i always points before last element
-            rlist.pop_back();
-        } else {
-            ++i;
-        }
+
+    // Number of hazard records ever created in the domain
+    static size_t Records() {
+        return Shared::listLen_.load();
     }
-}
+};
 
 #endif //DUMMY_HAZARDPOINTER_HPP
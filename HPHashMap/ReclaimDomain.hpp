@@ -0,0 +1,107 @@
+#ifndef DUMMY_RECLAIMDOMAIN_HPP
+#define DUMMY_RECLAIMDOMAIN_HPP
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <type_traits>
+
+// Bookkeeping shared by HazardDomain and EpochDomain: the list of
+// per-thread records, the thread local state and the hand-off of retired
+// objects that exited threads could not free yet. Record needs active_
+// and pNext_ members, Retired needs ptr and deleter. The domains name
+// their own nested types, so every domain gets separate statics.
+template<class Record, class Retired, class ThreadState>
+struct ReclaimDomain {
+    // Records are never freed, inactive ones wait for reuse
+    static inline std::atomic<Record*> pHead_{nullptr};
+    static inline std::atomic_size_t listLen_{0};
+    static inline std::atomic_size_t unreclaimed_{0};
+    // Retired objects left behind by exited threads
+    static inline std::mutex orphansMtx_;
+    static inline std::atomic_bool hasOrphans_{false};
+    struct Orphans {
+        std::vector<Retired> list;
+        // At exit no thread reads anything any more
+        ~Orphans() { for (const Retired &r : list) r.deleter(r.ptr); }
+    };
+    static inline Orphans orphans_;
+
+    // Trivially destructible, stays readable while other thread locals are torn down
+    static bool & alive() {
+        static thread_local bool flag = true;
+        return flag;
+    }
+    static ThreadState & Local() {
+        static thread_local ThreadState state;
+        return state;
+    }
+
+    // Reuses a record given back by an exited thread or links a new one
+    static Record * AcquireRecord() {
+        for (Record * p = pHead_.load(); p; p = p->pNext_) {
+            bool inactive = false;
+            if (!p->active_.load() && p->active_.compare_exchange_strong(inactive, true))
+                return p;
+        }
+        listLen_.fetch_add(1);
+        Record * p = new Record;
+        Record * old = pHead_.load();
+        do {
+            p->pNext_ = old;
+        } while (!pHead_.compare_exchange_weak(old, p));
+        return p;
+    }
+
+    // Leaves r to the next thread that reclaims, for retiring from another thread local's destructor
+    static void Orphan(const Retired &r) {
+        std::lock_guard lock(orphansMtx_);
+        orphans_.list.push_back(r);
+        hasOrphans_.store(true);
+    }
+
+    // Leaves what an exiting thread could not free to the next thread that reclaims
+    static void Orphan(const std::vector<Retired> &list) {
+        if (list.empty()) return;
+        std::lock_guard lock(orphansMtx_);
+        orphans_.list.insert(orphans_.list.end(), list.begin(), list.end());
+        hasOrphans_.store(true);
+    }
+
+    // Takes over whatever exited threads left behind
+    static void AdoptOrphans(std::vector<Retired> &list) {
+        if (!hasOrphans_.load(std::memory_order_relaxed)) return;
+        std::lock_guard lock(orphansMtx_);
+        list.insert(list.end(), orphans_.list.begin(), orphans_.list.end());
+        orphans_.list.clear();
+        hasOrphans_.store(false);
+    }
+
+    // Frees the entries of list that keep rejects and leaves the others.
+    // Deleters may retire more, so work on a copy.
+    template<class Keep>
+    static void Reclaim(std::vector<Retired> &list, Keep keep) {
+        std::vector<Retired> candidates;
+        candidates.swap(list);
+        size_t freed = 0;
+        for (const Retired &r : candidates) {
+            if (keep(r)) {
+                list.push_back(r);
+            } else {
+                r.deleter(r.ptr);
+                ++freed;
+            }
+        }
+        unreclaimed_.fetch_sub(freed, std::memory_order_relaxed);
+    }
+
+    // Type erased deleter for a Retired entry, the deleter type is part of it, so it must be stateless
+    template<class T, class Deleter>
+    static void (*Thunk())(void *) {
+        static_assert(std::is_empty_v<Deleter> && std::is_default_constructible_v<Deleter>,
+                      "Retire takes stateless deleters only");
+        return [] (void * p) { Deleter()(static_cast<T*>(p)); };
+    }
+};
+
+#endif //DUMMY_RECLAIMDOMAIN_HPP
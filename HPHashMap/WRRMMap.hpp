@@ -0,0 +1,154 @@
+#ifndef DUMMY_WRRMMAP_HPP
+#define DUMMY_WRRMMAP_HPP
+
+#include <span>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <exception>
+#include "HazardPointer.hpp"
+#include "EpochDomain.hpp"
+#include "FlatSnapshot.hpp"
+
+// Write-rarely-read-many map: readers use an immutable snapshot, writers
+// build a new one with their change and publish it. Snapshots are
+// FlatSnapshots, sorted arrays searched with SIMD, and replaced ones go
+// through the Reclaimer, HazardDomain or EpochDomain.
+//
+// Writers are flat combined: each one posts its updates to a publication
+// list, whoever gets the combiner role applies everything posted so far
+// in one new snapshot while the others wait for their request to be done.
+// Concurrent writers then cost one rebuild per batch instead of one per
+// update plus the rebuilds lost to failed CASes. Readers never wait.
+template<class Reclaimer = HazardDomain<>>
+class WRRMMap {
+    // Lives on the posting writer's stack until done is set
+    struct Request {
+        std::span<const std::pair<int, int>> updates;
+        Request * pNext = nullptr;
+        std::exception_ptr error;
+        std::atomic_bool done{false};
+    };
+
+    static constexpr int kCombineRounds = 4;
+
+    std::atomic<FlatSnapshot*> pMap_ = new FlatSnapshot();
+    std::atomic<Request*> pPending_{nullptr};
+    std::atomic_bool combining_{false};
+
+    // Publishes a snapshot with the updates applied, only called by the combiner
+    void Apply(std::span<const std::pair<int, int>> updates) {
+        FlatSnapshot * pOld = pMap_.load(std::memory_order_relaxed);
+        pMap_.store(pOld->With(updates).release());
+        Reclaimer::Retire(pOld);
+    }
+
+    // Applies the posted requests, only called by the combiner
+    void Combine() {
+        static thread_local std::vector<std::pair<int, int>> updates;
+        for (int round = 0; round < kCombineRounds; ++round) {
+            if (!pPending_.load(std::memory_order_relaxed)) return;
+            Request * pList = pPending_.exchange(nullptr, std::memory_order_acquire);
+            // The list is newest first, reverse it to apply in posting order
+            Request * pOrdered = nullptr;
+            while (pList) {
+                Request * pNext = pList->pNext;
+                pList->pNext = pOrdered;
+                pOrdered = pList;
+                pList = pNext;
+            }
+            std::exception_ptr error;
+            try {
+                if (!pOrdered->pNext) {
+                    Apply(pOrdered->updates);
+                } else {
+                    updates.clear();
+                    for (Request * p = pOrdered; p; p = p->pNext) updates.insert(updates.end(), p->updates.begin(), p->updates.end());
+                    Apply(updates);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            while (pOrdered) {
+                Request * pNext = pOrdered->pNext;
+                pOrdered->error = error;
+                pOrdered->done.store(true, std::memory_order_release); // the request may be gone right after
+                pOrdered = pNext;
+            }
+        }
+    }
+
+    bool TryCombine() {
+        return !combining_.load(std::memory_order_relaxed) && !combining_.exchange(true, std::memory_order_acquire);
+    }
+
+    // Serves whoever posted meanwhile and gives up the combiner role
+    void EndCombine() {
+        Combine();
+        combining_.store(false, std::memory_order_release);
+    }
+
+    void Post(std::span<const std::pair<int, int>> updates) {
+        // Uncontended, apply directly without posting
+        if (TryCombine()) {
+            try {
+                Apply(updates);
+            } catch (...) {
+                EndCombine();
+                throw;
+            }
+            EndCombine();
+            return;
+        }
+        Request request;
+        request.updates = updates;
+        Request * pHead = pPending_.load(std::memory_order_relaxed);
+        do {
+            request.pNext = pHead;
+        } while (!pPending_.compare_exchange_weak(pHead, &request, std::memory_order_release, std::memory_order_relaxed));
+        while (!request.done.load(std::memory_order_acquire)) {
+            if (TryCombine()) EndCombine();
+            else std::this_thread::yield();
+        }
+        if (request.error) std::rethrow_exception(request.error);
+    }
+
+public:
+    WRRMMap() = default;
+    WRRMMap(const WRRMMap&) = delete;
+    WRRMMap& operator=(const WRRMMap&) = delete;
+    // No thread may use the map while it is being destroyed
+    ~WRRMMap() {
+        delete pMap_.load();
+    }
+
+    void Update(const int &k, const int &v) {
+        const std::pair<int, int> update(k, v);
+        Post(std::span(&update, 1));
+    }
+
+    // Applies all updates in one snapshot, a later update of a key wins over an earlier one
+    void UpdateBatch(std::span<const std::pair<int, int>> updates) {
+        if (!updates.empty()) Post(updates);
+    }
+
+    std::optional<int> Find(const int &k) const {
+        typename Reclaimer::Guard guard;
+        return guard.Protect(pMap_)->Find(k);
+    }
+
+    // Value of the key, 0 if there is none
+    int Lookup(const int &k) const {
+        return Find(k).value_or(0);
+    }
+
+    size_t Size() const {
+        typename Reclaimer::Guard guard;
+        return guard.Protect(pMap_)->Size();
+    }
+};
+
+#endif //DUMMY_WRRMMAP_HPP
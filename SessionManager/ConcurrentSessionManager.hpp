@@ -0,0 +1,199 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <bit>
+#include "SessionManager.hpp"
+#include "../HPHashMap/HazardPointer.hpp"
+
+namespace Simple {
+    constexpr const size_t default_session_shards = 16;
+
+    /// Thread-safe session manager, stripes sessions across independently locked shards.
+    /// The shard is encoded in the low bits of the handle slot index, so every operation
+    /// on an existing session locks only the shard that owns it.
+    /// Sessions are heap nodes published per slot, so they can also be leased without locking;
+    /// a deleted node is reclaimed through hazard pointers once no lease refers to it.
+    /// Stats is forwarded to every shard, stats() merges them.
+    template<typename Session, size_t Shards = default_session_shards, typename Stats = NullSessionStats>
+        requires (Shards > 0 && (Shards & (Shards - 1)) == 0)
+    class ConcurrentSessionManager {
+        struct Node {
+            uint32_t generation;
+            Session session;
+            template<typename ...Params>
+            explicit Node(Params &&... params) : generation(0), session(std::forward<Params>(params)...) {}
+        };
+        using ShardManager = SessionManager<Node *, std::allocator<Node *>, SecureHandleGenerator, Stats>;
+        static constexpr const size_t shard_mask = Shards - 1;
+        static constexpr const uint32_t shard_bits = std::countr_zero(Shards);
+
+        struct alignas(64) Shard {
+            std::mutex mtx;
+            ShardManager sessions;
+            alignas(64) std::atomic_size_t count; // read lock free by count(), kept off the mutex's line
+            const size_t max_sessions;
+            std::unique_ptr<std::atomic<Node *>[]> published; // local slot index -> live node
+            explicit Shard(size_t max_sessions)
+                : mtx(), sessions(max_sessions), count(0), max_sessions(max_sessions),
+                  published(new std::atomic<Node *>[max_sessions]()) {
+            };
+            ~Shard() {
+                // Retired rather than deleted, a lease may outlive the manager
+                sessions.for_each_session([] (Node * node) { HazardDomain<>::Retire(node); });
+            }
+        };
+        std::array<Shard, Shards> shards;
+
+        template<size_t ...Idx>
+        [[nodiscard]] static std::array<Shard, Shards> make_shards(size_t max_sessions, std::index_sequence<Idx...>) {
+            return {Shard(max_sessions / Shards + (Idx < max_sessions % Shards))...};
+        }
+
+        [[nodiscard]] static size_t home_shard() {
+            static thread_local const size_t home = std::hash<std::thread::id>()(std::this_thread::get_id());
+            return home;
+        }
+
+        [[nodiscard]] static size_t to_local(const size_t & sess_handle) {
+            return ShardManager::make_handle(ShardManager::handle_index(sess_handle) >> shard_bits,
+                                             ShardManager::handle_generation(sess_handle));
+        }
+
+        [[nodiscard]] static size_t to_global(const size_t & sess_handle, size_t shard) {
+            return ShardManager::make_handle(ShardManager::handle_index(sess_handle) << shard_bits | shard,
+                                             ShardManager::handle_generation(sess_handle));
+        }
+
+        [[nodiscard]] Shard & shard_of(const size_t & sess_handle) {
+            return shards[ShardManager::handle_index(sess_handle) & shard_mask];
+        }
+
+        void throw_if_shard_empty(const Shard & shard) const {
+            if (shard.sessions.empty())
+                throw SessionInvalid(empty() ? "Manager is empty" : "Session does not exist");
+        }
+
+    public:
+        using SessionInvalid = typename ShardManager::SessionInvalid;
+
+        /// Lock-free access to a session. The session stays alive for the lifetime of the lease,
+        /// even if it is concurrently deleted from the manager or the manager is destroyed.
+        class SessionLease {
+            HazardDomain<>::Guard guard_;
+            Session * session_;
+            SessionLease (HazardDomain<>::Guard && guard, Session * session) : guard_(std::move(guard)), session_(session) {};
+        public:
+            SessionLease ()                    = delete;
+            SessionLease (const SessionLease&) = delete;
+            SessionLease& operator= (const SessionLease&) = delete;
+            SessionLease (SessionLease && other) noexcept
+                : guard_(std::move(other.guard_)), session_(std::exchange(other.session_, nullptr)) {
+            };
+            SessionLease& operator= (SessionLease && other) noexcept {
+                std::swap(guard_, other.guard_);
+                std::swap(session_, other.session_);
+                return *this;
+            }
+            [[nodiscard]] Session & operator* () const { return *session_; }
+            [[nodiscard]] Session * operator-> () const { return session_; }
+            [[nodiscard]] Session * get () const { return session_; }
+            friend ConcurrentSessionManager;
+        };
+
+        /// Capacity is split evenly across the shards, the remainder goes to the first ones.
+        explicit ConcurrentSessionManager(size_t max_sessions = default_max_sessions)
+            : shards(make_shards(max_sessions, std::make_index_sequence<Shards>())) {
+            if ((max_sessions / Shards + 1) << shard_bits >= UINT32_MAX)
+                throw SessionInvalid("Manager capacity exceeds handle range");
+        };
+        ConcurrentSessionManager(const ConcurrentSessionManager &) = delete;
+        ConcurrentSessionManager(ConcurrentSessionManager &&)      = delete;
+        ConcurrentSessionManager& operator=(const ConcurrentSessionManager &) = delete;
+        ConcurrentSessionManager& operator=(ConcurrentSessionManager &&)      = delete;
+
+        /// Creates a session in the calling thread's home shard, falls back to the next ones when it is full.
+        /// The session itself is constructed before any lock is taken.
+        template<typename ...Params>
+        [[nodiscard]] size_t new_session(Params &&... params) {
+            auto node = std::make_unique<Node>(std::forward<Params>(params)...);
+            const size_t home = home_shard();
+            for (size_t i = 0; i < Shards; ++i) {
+                const size_t shard_idx = (home + i) & shard_mask;
+                Shard & shard = shards[shard_idx];
+                if (shard.count.load(std::memory_order_relaxed) >= shard.max_sessions) continue;
+                std::lock_guard lock(shard.mtx);
+                if (shard.sessions.count() >= shard.max_sessions) continue;
+                size_t sess_handle = shard.sessions.new_session(node.get());
+                node->generation = ShardManager::handle_generation(sess_handle);
+                shard.published[ShardManager::handle_index(sess_handle)].store(node.release(), std::memory_order_release);
+                shard.count.store(shard.sessions.count(), std::memory_order_relaxed);
+                return to_global(sess_handle, shard_idx);
+            }
+            throw SessionInvalid("Manager is full");
+        }
+
+        /// Invokes visitor with the session while its shard is locked, returns whatever the visitor returns.
+        template<typename Visitor>
+        decltype(auto) visit_session(const size_t & sess_handle, Visitor && visitor) {
+            Shard & shard = shard_of(sess_handle);
+            std::lock_guard lock(shard.mtx);
+            throw_if_shard_empty(shard);
+            return std::invoke(std::forward<Visitor>(visitor), shard.sessions.get_session(to_local(sess_handle))->session);
+        }
+
+        /// Leases the session without taking any lock, throws if there is no such session.
+        /// Only the lifetime is guarded, access through the lease is not serialised with visit_session().
+        [[nodiscard]] SessionLease acquire_session(const size_t & sess_handle) {
+            const size_t local = to_local(sess_handle);
+            const uint32_t index = ShardManager::handle_index(local);
+            Shard & shard = shard_of(sess_handle);
+            if (index < shard.max_sessions) {
+                HazardDomain<>::Guard guard;
+                Node * node = guard.Protect(shard.published[index]);
+                if (node && node->generation == ShardManager::handle_generation(local))
+                    return SessionLease(std::move(guard), &node->session);
+            }
+            throw SessionInvalid(empty() ? "Manager is empty" : "Session does not exist");
+        }
+
+        /// Unpublishes the session, its memory is reclaimed once the last lease on it is gone.
+        void delete_session(const size_t & sess_handle) {
+            Shard & shard = shard_of(sess_handle);
+            Node * node;
+            {
+                std::lock_guard lock(shard.mtx);
+                throw_if_shard_empty(shard);
+                const size_t local = to_local(sess_handle);
+                shard.sessions.delete_session(local); // validates the handle, the published node is its session
+                // seq_cst like the readers' protect, so the retire scan can't miss a hazard set before the unpublish
+                node = shard.published[ShardManager::handle_index(local)].exchange(nullptr, std::memory_order_seq_cst);
+                shard.count.store(shard.sessions.count(), std::memory_order_relaxed);
+            }
+            HazardDomain<>::Retire(node);
+        }
+
+        /// Sum of per-shard counters, takes no locks and may be stale under concurrent updates.
+        [[nodiscard]] size_t count() const {
+            size_t total = 0;
+            for (const Shard & shard : shards) total += shard.count.load(std::memory_order_relaxed);
+            return total;
+        }
+        [[nodiscard]] bool empty() const { return count() == 0; }
+
+        /// Sum of the shard statistics, every shard is locked in turn while it is read.
+        /// Lock-free leases are not timed and a full manager is not counted, as neither reaches a shard.
+        [[nodiscard]] SessionStatsSnapshot stats() requires Stats::enabled {
+            SessionStatsSnapshot result;
+            for (Shard & shard : shards) {
+                std::lock_guard lock(shard.mtx);
+                result += shard.sessions.stats();
+            }
+            return result;
+        }
+    };
+}
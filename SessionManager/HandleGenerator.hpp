@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <random>
+#include <cstdint>
+#include <utility>
+#include <concepts>
+#include <stdexcept>
+#include <ctime>
+#include <openssl/rand.h>
+#include <boost/random.hpp>
+
+namespace Simple {
+    /// Source of the random generation bits mixed into session handles.
+    /// next() must be safe to call concurrently from any thread.
+    template<typename Generator> concept HandleGenerator = requires {
+        { Generator::next() } -> std::same_as<uint32_t>;
+    };
+
+    /// Cryptographically secure generator. Every thread refills its own buffer through OpenSSL RAND_bytes,
+    /// so the CSPRNG cost is amortised over buffer_size handles. Consumed values are wiped from the buffer.
+    class SecureHandleGenerator {
+        static constexpr const size_t buffer_size = 1024;
+        struct Buffer {
+            std::array<uint32_t, buffer_size> values;
+            size_t pos = buffer_size;
+        };
+    public:
+        [[nodiscard]] static uint32_t next() {
+            static thread_local Buffer buffer;
+            if (buffer.pos == buffer_size) {
+                if (RAND_bytes(reinterpret_cast<unsigned char *>(buffer.values.data()), sizeof(buffer.values)) != 1)
+                    throw std::runtime_error("RAND_bytes failed");
+                buffer.pos = 0;
+            }
+            return std::exchange(buffer.values[buffer.pos++], 0);
+        }
+    };
+
+    /// Fast non-cryptographic generator, per-thread splitmix64 seeded from std::random_device.
+    /// Handles are hard to guess by accident but not by an attacker observing them.
+    class FastHandleGenerator {
+    public:
+        [[nodiscard]] static uint32_t next() {
+            static thread_local uint64_t state = (uint64_t(std::random_device()()) << 32) | std::random_device()();
+            uint64_t z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+        }
+    };
+
+    /// Per-thread Mersenne Twister seeded with the start time, the original handle generator.
+    class Mt19937HandleGenerator {
+    public:
+        [[nodiscard]] static uint32_t next() {
+            static thread_local boost::mt19937 randomizer(time(nullptr));
+            return randomizer();
+        }
+    };
+}
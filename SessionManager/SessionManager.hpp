@@ -1,30 +1,187 @@
 #pragma once
 
-#include <unordered_map>
-#include <openssl/sha.h>
-#include <boost/random.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <span>
+#include <atomic>
+#include <exception>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <memory_resource>
+#include "TimingWheel.hpp"
+#include "SessionSnapshot.hpp"
+#include "HandleGenerator.hpp"
+#include "SessionStats.hpp"
+#include "../Common/WorkStealingPool.hpp"
 
 namespace Simple {
     constexpr const size_t default_max_sessions = 1000;
 
-    template<typename Session>
-        requires std::is_default_constructible_v<Session>
+    /// Sessions are constructed in place from the new_session() arguments and stored by value in one dense array,
+    /// the last session is moved into the gap a deleted one leaves. A session therefore doesn't keep its address:
+    /// creating, deleting or expiring sessions, reserve() and restore() invalidate references to any of them.
+    /// Keep the handle and look the session up again instead. Allocator serves every internal
+    /// buffer (rebound as needed), after reserve() session churn performs no further allocations.
+    /// HandleGen supplies the random generation bits of handles, see HandleGenerator.hpp.
+    /// Stats = SessionStats enables counters and latency histograms read through stats(), the default compiles them out.
+    template<typename Session, typename Allocator = std::allocator<Session>, HandleGenerator HandleGen = SecureHandleGenerator,
+             typename Stats = NullSessionStats>
+        requires std::is_move_constructible_v<Session>
     class SessionManager {
-        std::unordered_map<size_t, Session> sessions;
+    public:
+        using Clock = std::chrono::steady_clock;
+        using OnExpire = std::function<void (size_t, Session &)>;
+        using allocator_type = Allocator;
+    private:
+        template<typename T> using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+        // A handle packs the slot index (low 32 bits) with the slot generation (high 32 bits).
+        // Generation starts random and every reuse of the slot advances it by a random odd step, so a stale
+        // handle never resolves to the next occupant and a handle can't be predicted from earlier ones.
+        static constexpr const uint32_t npos = UINT32_MAX;
+        struct Slot {
+            uint32_t generation;
+            uint32_t link; // dense index while the slot is alive, next free slot otherwise
+        };
+        std::vector<Slot, Rebind<Slot>> slots;
+        std::vector<Session, Allocator> sessions; // densely packed, swap-removed on delete
+        std::vector<uint32_t, Rebind<uint32_t>> owners; // dense index -> slot index
+        uint32_t free_head;
         const size_t max_sessions;
+        // Idle expiry, one wheel tick per millisecond since epoch. Disabled when idle_ticks is 0.
+        const Clock::time_point epoch;
+        const TimingWheel::Tick idle_ticks;
+        BasicTimingWheel<Rebind<std::byte>> wheel;
+        std::vector<TimingWheel::Tick, Rebind<TimingWheel::Tick>> last_seen; // slot index -> wheel tick of the last access
+        OnExpire on_expire;
+        // Incremental snapshots into the two copies of the file in turn. A copy is behind by the slots
+        // touched since the last snapshot() plus the ones the previous snapshot() wrote to the other copy.
+        std::unique_ptr<SnapshotFile> snapshot_file;
+        std::vector<uint32_t, Rebind<uint32_t>> dirty_slots;
+        std::vector<bool, Rebind<bool>> dirty_flags; // slot index -> already queued in dirty_slots
+        std::vector<uint32_t, Rebind<uint32_t>> previous_dirty; // dirty_slots of the previous snapshot()
+        std::vector<uint32_t, Rebind<uint32_t>> snapshot_writes;
+        bool all_dirty;
+        bool previous_all_dirty;
+        unsigned snapshot_area; // copy the next snapshot() writes
+        [[no_unique_address]] Stats stats_;
+
+        void mark_dirty(uint32_t index) {
+            if (!snapshot_file || all_dirty) return;
+            if (index >= dirty_flags.size()) dirty_flags.resize(index + 1);
+            if (dirty_flags[index]) return;
+            dirty_flags[index] = true;
+            dirty_slots.push_back(index);
+        }
+
+        void write_slot(uint32_t index, unsigned area) {
+            SnapshotSlot & record = snapshot_file->slot(index, area);
+            record.generation = slots[index].generation;
+            record.live = is_alive(index);
+            if (record.live) std::memcpy(snapshot_file->payload(index, area), &sessions[slots[index].link], sizeof(Session));
+        }
+
+        // Wheel tick of the current time, never behind the last expire_idle() sweep
+        [[nodiscard]] TimingWheel::Tick current_tick() const {
+            auto ticks = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch).count();
+            return std::max<TimingWheel::Tick>(wheel.now(), ticks);
+        }
+
+        [[nodiscard]] bool on_wheel_expire(uint32_t index, TimingWheel::Tick now) {
+            if (last_seen[index] + idle_ticks > now) {
+                wheel.schedule(index, last_seen[index] + idle_ticks);
+                return false;
+            }
+            size_t sess_handle = make_handle(index, slots[index].generation);
+            if (on_expire) on_expire(sess_handle, sessions[slots[index].link]);
+            erase_session(slots[index].link, index);
+            stats_.record(SessionEvent::Expired);
+            return true;
+        }
 
-        [[nodiscard]] typename std::unordered_map<size_t, Session>::iterator find_session_or_throw(const size_t & sess_handle) {
-            if (sessions.empty()) throw SessionInvalid("Manager is empty");
-            auto p_sess = sessions.find(sess_handle);
-            if (p_sess == sessions.end()) throw SessionInvalid("Session does not exist");
-            return p_sess;
+        [[nodiscard]] bool is_alive(uint32_t index) const {
+            return slots[index].link < owners.size() && owners[slots[index].link] == index;
         }
 
-        [[nodiscard]] static size_t gen_handle(const size_t &upper_limit) {
-            static boost::mt19937 randomizer(time(nullptr));
-            static boost::uniform_int<> allowed_keys(0, upper_limit);
-            static boost::variate_generator<boost::mt19937, boost::uniform_int<>> keygen(randomizer, allowed_keys);
-            return keygen();
+        [[nodiscard]] uint32_t find_session_or_throw(const size_t & sess_handle) const {
+            if (sessions.empty()) {
+                stats_.record(SessionEvent::LookupMiss);
+                throw SessionInvalid("Manager is empty");
+            }
+            auto index = handle_index(sess_handle);
+            if (index >= slots.size() || slots[index].generation != handle_generation(sess_handle) || !is_alive(index)) {
+                stats_.record(SessionEvent::LookupMiss);
+                throw SessionInvalid("Session does not exist");
+            }
+            return slots[index].link;
+        }
+
+        // Everything that may allocate or throw runs before the session is constructed and leaves the manager
+        // consistent, a new slot waits on the free list, so a throw anywhere creates nothing.
+        template<typename ...Params>
+        [[nodiscard]] size_t emplace_session(Params &&... params) {
+            const bool fresh = free_head == npos;
+            if (fresh) {
+                slots.push_back({HandleGen::next(), npos});
+                free_head = static_cast<uint32_t>(slots.size() - 1);
+            }
+            const uint32_t index = free_head;
+            const uint32_t generation = fresh ? slots[index].generation : slots[index].generation + (HandleGen::next() | 1);
+            if (owners.size() == owners.capacity()) owners.reserve(std::max<size_t>(2 * owners.capacity(), 1));
+            mark_dirty(index);
+            if (idle_ticks) {
+                if (index >= last_seen.size()) last_seen.resize(index + 1);
+                last_seen[index] = current_tick();
+                wheel.schedule(index, last_seen[index] + idle_ticks);
+            }
+            try {
+                sessions.emplace_back(std::forward<Params>(params)...);
+            } catch (...) {
+                if (idle_ticks) wheel.cancel(index);
+                throw;
+            }
+            free_head = slots[index].link;
+            slots[index] = {generation, static_cast<uint32_t>(sessions.size() - 1)};
+            owners.push_back(index);
+            if (!fresh) stats_.record(SessionEvent::SlotReused);
+            return make_handle(index, generation);
+        }
+
+        void erase_session(uint32_t dense, uint32_t index) {
+            if (dense != sessions.size() - 1) {
+                if constexpr (std::is_move_assignable_v<Session>) {
+                    sessions[dense] = std::move(sessions.back());
+                } else {
+                    Allocator alloc = sessions.get_allocator();
+                    std::allocator_traits<Allocator>::destroy(alloc, &sessions[dense]);
+                    std::allocator_traits<Allocator>::construct(alloc, &sessions[dense], std::move(sessions.back()));
+                }
+                owners[dense] = owners.back();
+                slots[owners[dense]].link = dense;
+            }
+            sessions.pop_back();
+            owners.pop_back();
+            slots[index].link = std::exchange(free_head, index);
+            if (idle_ticks) wheel.cancel(index);
+            mark_dirty(index);
+        }
+
+        template<typename Visitor>
+        void visit_range(Visitor & visitor, size_t begin, size_t end) {
+            for (size_t dense = begin; dense < end; ++dense) {
+                if constexpr (std::is_invocable_v<Visitor &, size_t, Session &>)
+                    visitor(make_handle(owners[dense], slots[owners[dense]].generation), sessions[dense]);
+                else
+                    visitor(sessions[dense]);
+            }
         }
 
     public:
@@ -46,7 +203,31 @@ namespace Simple {
             }
         };
 
-        explicit SessionManager(size_t max_sessions = default_max_sessions) : sessions(), max_sessions(max_sessions) {};
+        [[nodiscard]] static constexpr size_t make_handle(uint32_t index, uint32_t generation) {
+            return static_cast<size_t>(generation) << 32 | index;
+        }
+        [[nodiscard]] static constexpr uint32_t handle_index(size_t sess_handle) {
+            return static_cast<uint32_t>(sess_handle);
+        }
+        [[nodiscard]] static constexpr uint32_t handle_generation(size_t sess_handle) {
+            return static_cast<uint32_t>(sess_handle >> 32);
+        }
+
+        explicit SessionManager(size_t max_sessions = default_max_sessions, const Allocator & alloc = Allocator())
+            : SessionManager(max_sessions, std::chrono::milliseconds::zero(), OnExpire(), alloc) {
+        };
+
+        /// Sessions not accessed for idle_timeout are deleted by expire_idle(), on_expire is invoked right before.
+        /// The callback must not delete the expiring session itself.
+        SessionManager(size_t max_sessions, std::chrono::milliseconds idle_timeout, OnExpire on_expire = OnExpire(),
+                       const Allocator & alloc = Allocator())
+            : slots(alloc), sessions(alloc), owners(alloc), free_head(npos), max_sessions(max_sessions),
+              epoch(Clock::now()), idle_ticks(idle_timeout.count()), wheel(alloc), last_seen(alloc), on_expire(std::move(on_expire)),
+              snapshot_file(), dirty_slots(alloc), dirty_flags(alloc), previous_dirty(alloc), snapshot_writes(alloc),
+              all_dirty(false), previous_all_dirty(false), snapshot_area(0), stats_() {
+            if (max_sessions >= npos) throw SessionInvalid("Manager capacity exceeds handle range");
+            if (idle_timeout.count() < 0) throw SessionInvalid("Idle timeout is negative");
+        };
         SessionManager(const SessionManager &) = delete;
         SessionManager(SessionManager &&)      = delete;
         SessionManager& operator=(const SessionManager &) = delete;
@@ -54,22 +235,225 @@ namespace Simple {
 
         template<typename ...Params>
         [[nodiscard]] size_t new_session(Params &&... params) {
-            if (sessions.size() >= max_sessions) throw SessionInvalid("Manager is full");
-            size_t sess_handle;// = gen_unique_key(gen_secret(max_sessions));
-            do sess_handle = gen_handle(max_sessions); while (sessions.find(sess_handle) != sessions.end());
-            sessions[sess_handle] = std::move(Session(std::forward<Params>(params)...));
+            auto timer = stats_.start();
+            if (sessions.size() >= max_sessions) {
+                stats_.record(SessionEvent::Full);
+                throw SessionInvalid("Manager is full");
+            }
+            size_t sess_handle = emplace_session(std::forward<Params>(params)...);
+            stats_.record(SessionEvent::Created);
+            stats_.finish(SessionOp::Create, timer);
             return sess_handle;
         }
 
+        /// Creates out.size() sessions from the same constructor arguments and stores their handles in out.
+        /// Either all sessions are created or, if the manager lacks room or a constructor throws, none.
+        template<typename ...Params>
+        void new_sessions(std::span<size_t> out, const Params &... params) {
+            auto timer = stats_.start();
+            if (out.size() > max_sessions - sessions.size()) {
+                stats_.record(SessionEvent::Full);
+                throw SessionInvalid("Manager is full");
+            }
+            size_t created = 0;
+            try {
+                for (; created < out.size(); ++created) out[created] = emplace_session(params...);
+            } catch (...) {
+                while (created--) erase_session(find_session_or_throw(out[created]), handle_index(out[created]));
+                throw;
+            }
+            stats_.record(SessionEvent::Created, out.size());
+            stats_.finish(SessionOp::Create, timer, out.size());
+        }
+
+        /// Returns the session and, if idle expiry is enabled, marks it as accessed now.
+        /// The reference is invalidated by the next call that creates, deletes or expires a session.
         [[nodiscard]] Session &get_session(const size_t &sess_handle) {
-            return std::forward<Session &>(find_session_or_throw(sess_handle)->second);
+            auto timer = stats_.start();
+            uint32_t dense = find_session_or_throw(sess_handle);
+            if (idle_ticks) last_seen[handle_index(sess_handle)] = current_tick();
+            mark_dirty(handle_index(sess_handle));
+            stats_.finish(SessionOp::Lookup, timer);
+            return sessions[dense];
         }
 
         void delete_session(const size_t &sess_handle) {
-            sessions.erase(find_session_or_throw(sess_handle)->first);
+            auto timer = stats_.start();
+            erase_session(find_session_or_throw(sess_handle), handle_index(sess_handle));
+            stats_.record(SessionEvent::Deleted);
+            stats_.finish(SessionOp::Delete, timer);
+        }
+
+        /// Deletes sessions in order, throws at the first invalid handle leaving the preceding ones deleted.
+        void delete_sessions(std::span<const size_t> sess_handles) {
+            auto timer = stats_.start();
+            size_t deleted = 0;
+            try {
+                for (; deleted < sess_handles.size(); ++deleted) {
+                    erase_session(find_session_or_throw(sess_handles[deleted]), handle_index(sess_handles[deleted]));
+                    stats_.record(SessionEvent::Deleted);
+                }
+            } catch (...) {
+                stats_.finish(SessionOp::Delete, timer, deleted);
+                throw;
+            }
+            stats_.finish(SessionOp::Delete, timer, deleted);
+        }
+
+        /// Invokes visitor(session) or visitor(handle, session) for every session, in storage order.
+        /// Visiting does not count as an access for idle expiry. The visitor must not create or delete sessions.
+        template<typename Visitor>
+        void for_each_session(Visitor && visitor) {
+            if (snapshot_file) all_dirty = true;
+            visit_range(visitor, 0, sessions.size());
+        }
+
+        /// Same as for_each_session(), but spreads the sessions over the pool's threads, the calling thread included.
+        /// The visitor must be safe to call concurrently for distinct sessions. Once it throws, the sessions not
+        /// reached yet are skipped and the first exception is rethrown.
+        template<typename Visitor>
+        void parallel_for_each_session(Visitor && visitor, WorkStealingPool & pool = WorkStealingPool::shared()) {
+            if (snapshot_file) all_dirty = true; // before any worker starts
+            std::atomic_flag failed;
+            std::exception_ptr error;
+            pool.run(sessions.size(), [&] (size_t dense) {
+                if (failed.test(std::memory_order_relaxed)) return;
+                try {
+                    visit_range(visitor, dense, dense + 1);
+                } catch (...) {
+                    if (!failed.test_and_set()) error = std::current_exception();
+                }
+            });
+            if (error) std::rethrow_exception(error);
+        }
+
+        /// Deletes every session idle for longer than the configured timeout, returns how many were expired.
+        /// Cost is proportional to the elapsed time and the number of expired sessions, not to count().
+        size_t expire_idle(Clock::time_point now = Clock::now()) {
+            if (!idle_ticks || now <= epoch) return 0;
+            size_t expired = 0;
+            auto ticks = std::chrono::duration_cast<std::chrono::milliseconds>(now - epoch).count();
+            wheel.advance(ticks, [this, &expired] (uint32_t index, TimingWheel::Tick tick) {
+                expired += on_wheel_expire(index, tick);
+            });
+            return expired;
+        }
+
+        /// Starts snapshotting into a new file at path, writing the full current state.
+        /// Later snapshot() calls only rewrite slots created, deleted or accessed in the meantime.
+        void attach_snapshot(const std::filesystem::path & path) requires std::is_trivially_copyable_v<Session> {
+            snapshot_file = std::make_unique<SnapshotFile>(path, true, sizeof(Session), alignof(Session));
+            snapshot_area = 0;
+            all_dirty = previous_all_dirty = true;
+            snapshot();
+        }
+
+        /// Brings the older copy in the attached snapshot file up to date and makes it the current one.
+        /// Costs O(slots touched since the previous two calls), only the pages holding them are synced
+        /// to disk, plus the header twice. Returns the number of slot records written.
+        /// A crash meanwhile leaves the file with the snapshot of the previous call.
+        size_t snapshot() requires std::is_trivially_copyable_v<Session> {
+            if (!snapshot_file) throw SessionInvalid("No snapshot attached");
+            snapshot_file->reserve(slots.size());
+            const unsigned area = snapshot_area;
+            SnapshotArea & header = snapshot_file->area(area);
+            header.begin_epoch = snapshot_file->next_epoch();
+            header.slot_count = slots.size();
+            snapshot_file->flush_header(); // on disk before any record of this copy may be
+            size_t written;
+            if (all_dirty || previous_all_dirty) {
+                for (uint32_t index = 0; index < slots.size(); ++index) write_slot(index, area);
+                snapshot_file->flush_records(slots.size(), area);
+                written = slots.size();
+            } else {
+                snapshot_writes.assign(dirty_slots.begin(), dirty_slots.end());
+                snapshot_writes.insert(snapshot_writes.end(), previous_dirty.begin(), previous_dirty.end());
+                std::sort(snapshot_writes.begin(), snapshot_writes.end());
+                snapshot_writes.erase(std::unique(snapshot_writes.begin(), snapshot_writes.end()), snapshot_writes.end());
+                for (uint32_t index : snapshot_writes) write_slot(index, area);
+                snapshot_file->flush_records(snapshot_writes, area);
+                written = snapshot_writes.size();
+            }
+            header.end_epoch = header.begin_epoch;
+            snapshot_file->flush_header();
+            snapshot_area ^= 1;
+            for (uint32_t index : dirty_slots) dirty_flags[index] = false;
+            previous_dirty.swap(dirty_slots);
+            dirty_slots.clear();
+            previous_all_dirty = std::exchange(all_dirty, false);
+            return written;
+        }
+
+        /// Loads sessions from a snapshot into this empty manager, keeping their handles valid.
+        /// Throws without changing the manager if the file is invalid or storage can't be allocated.
+        /// The file stays attached, so following snapshot() calls update it incrementally.
+        void restore(const std::filesystem::path & path) requires std::is_trivially_copyable_v<Session> {
+            if (!sessions.empty()) throw SessionInvalid("Manager is not empty");
+            auto file = std::make_unique<SnapshotFile>(path, false, sizeof(Session), alignof(Session));
+            const auto area = static_cast<unsigned>(file->latest_area());
+            const size_t slot_count = file->area(area).slot_count;
+            if (slot_count > max_sessions) throw SessionInvalid("Snapshot exceeds manager capacity");
+            reserve(slot_count); // the only step that may throw, the tables below are filled within capacity
+            slots.assign(slot_count, Slot{0, 0});
+            free_head = npos;
+            for (size_t i = slot_count; i--;) {
+                const auto index = static_cast<uint32_t>(i);
+                const SnapshotSlot & record = file->slot(index, area);
+                slots[index].generation = record.generation;
+                if (!record.live) {
+                    slots[index].link = std::exchange(free_head, index);
+                    continue;
+                }
+                std::array<std::byte, sizeof(Session)> payload;
+                std::memcpy(payload.data(), file->payload(index, area), sizeof(Session));
+                sessions.push_back(std::bit_cast<Session>(payload));
+                owners.push_back(index);
+                slots[index].link = static_cast<uint32_t>(sessions.size() - 1);
+                if (idle_ticks) {
+                    if (index >= last_seen.size()) last_seen.resize(index + 1);
+                    last_seen[index] = current_tick();
+                    wheel.schedule(index, last_seen[index] + idle_ticks);
+                }
+            }
+            snapshot_file = std::move(file);
+            dirty_slots.clear();
+            dirty_flags.clear();
+            previous_dirty.clear();
+            // The other copy may be older or torn, the next snapshot() rewrites it completely
+            snapshot_area = area ^ 1;
+            all_dirty = false;
+            previous_all_dirty = true;
+        }
+
+        /// Preallocates storage for n sessions, so creating up to n of them allocates nothing.
+        void reserve(size_t n) {
+            n = std::min(n, max_sessions);
+            slots.reserve(n);
+            sessions.reserve(n);
+            owners.reserve(n);
+            if (idle_ticks) {
+                last_seen.reserve(n);
+                wheel.reserve(n);
+            }
         }
 
         [[nodiscard]] size_t count() const { return sessions.size(); }
         [[nodiscard]] bool empty() const { return sessions.empty(); }
+        [[nodiscard]] allocator_type get_allocator() const { return sessions.get_allocator(); }
+
+        /// Counters and latencies recorded so far plus the current occupancy.
+        [[nodiscard]] SessionStatsSnapshot stats() const requires Stats::enabled {
+            SessionStatsSnapshot result = stats_.snapshot();
+            result.sessions = sessions.size();
+            result.capacity = max_sessions;
+            result.slots = slots.size();
+            result.free_slots = slots.size() - sessions.size();
+            return result;
+        }
     };
-}
\ No newline at end of file
+
+    namespace pmr {
+        template<typename Session, HandleGenerator HandleGen = SecureHandleGenerator, typename Stats = NullSessionStats>
+        using SessionManager = Simple::SessionManager<Session, std::pmr::polymorphic_allocator<Session>, HandleGen, Stats>;
+    }
+}
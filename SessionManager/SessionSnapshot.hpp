@@ -0,0 +1,205 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace Simple {
+    constexpr const uint32_t snapshot_version = 3;
+    constexpr const char snapshot_magic[8] = "SMSNAP3";
+    static_assert(snapshot_magic[6] == '0' + snapshot_version, "the magic names the format version");
+
+    /// State of one of the two copies of the slot records. An update of a copy sets begin_epoch past
+    /// every epoch in the file and syncs it, writes and syncs the records, then publishes
+    /// end_epoch = begin_epoch and syncs it. A crash leaves at most the copy being written torn,
+    /// the other one still holds the previous complete snapshot.
+    struct SnapshotArea {
+        uint64_t begin_epoch; // 0 while the copy was never written
+        uint64_t end_epoch;
+        uint64_t slot_count; // slot records in use
+        uint64_t reserved;
+    };
+
+    /// Fixed header at the beginning of a snapshot file.
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t session_size;
+        uint64_t capacity; // slot records present in each copy
+        uint64_t session_align; // the record layout depends on it as much as on session_size
+        uint64_t reserved[4];
+        SnapshotArea areas[2];
+    };
+    static_assert(sizeof(SnapshotHeader) == 128);
+
+    /// Per-slot record, the session payload follows at the next suitably aligned offset.
+    struct SnapshotSlot {
+        uint32_t generation;
+        uint32_t live;
+    };
+
+    /// Memory-mapped snapshot file made of a header and two fixed-size records per session slot, one for
+    /// each copy, so single slots can be rewritten in place and the file grows by appending records.
+    /// Updates alternate between the copies, the one not being written stays intact.
+    class SnapshotFile {
+        int fd_;
+        std::byte * base_;
+        size_t size_;
+        const size_t payload_offset_; // within a record
+        const size_t record_size_;
+        const size_t records_offset_;
+        const size_t page_size_;
+
+        [[nodiscard]] size_t record_offset(size_t index, unsigned area) const {
+            return records_offset_ + (2 * index + area) * record_size_;
+        }
+
+        // Syncs the pages overlapping [begin, end) of the mapping
+        void sync(size_t begin, size_t end) {
+            begin -= begin % page_size_;
+            if (msync(base_ + begin, end - begin, MS_SYNC) != 0) throw_errno("Snapshot msync failed");
+        }
+
+        [[noreturn]] static void throw_errno(const std::string & what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        // Maps the file at the given size, growing it if needed. The old mapping is only dropped once the new
+        // one is in place, so a failure leaves the file usable as it was.
+        void map(size_t size) {
+            if (ftruncate(fd_, static_cast<off_t>(size)) != 0) throw_errno("Snapshot resize failed");
+            void * base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (base == MAP_FAILED) throw_errno("Snapshot mmap failed");
+            if (base_) munmap(base_, size_);
+            base_ = static_cast<std::byte *>(base);
+            size_ = size;
+        }
+
+    public:
+        class SnapshotInvalid : std::exception {
+            std::string e;
+        public:
+            SnapshotInvalid() = delete;
+            SnapshotInvalid(SnapshotInvalid &&) = delete;
+            SnapshotInvalid(const SnapshotInvalid &) = delete;
+            explicit SnapshotInvalid(std::string reason) : e(std::move(reason)) {};
+            [[nodiscard]] const char *what() const noexcept override {
+                return e.c_str();
+            }
+        };
+
+        /// Opens (truncate = false) or creates anew (truncate = true) a snapshot of sessions of the given size.
+        SnapshotFile(const std::filesystem::path & path, bool truncate, size_t session_size, size_t session_align)
+            : fd_(-1), base_(nullptr), size_(0),
+              payload_offset_(std::max(sizeof(SnapshotSlot), session_align)),
+              record_size_((payload_offset_ + session_size + session_align - 1) / session_align * session_align),
+              records_offset_(std::max(sizeof(SnapshotHeader), session_align)),
+              page_size_(static_cast<size_t>(sysconf(_SC_PAGESIZE))) {
+            fd_ = ::open(path.c_str(), O_RDWR | (truncate ? O_CREAT | O_TRUNC : 0), 0644);
+            if (fd_ < 0) throw_errno("Snapshot open failed");
+            struct stat st{};
+            if (fstat(fd_, &st) != 0) { ::close(fd_); throw_errno("Snapshot stat failed"); }
+            try {
+                if (truncate) {
+                    map(records_offset_);
+                    std::memcpy(header().magic, snapshot_magic, sizeof(snapshot_magic));
+                    header().version = snapshot_version;
+                    header().session_size = static_cast<uint32_t>(session_size);
+                    header().session_align = session_align;
+                    return;
+                }
+                if (static_cast<size_t>(st.st_size) < records_offset_) throw SnapshotInvalid("Snapshot is truncated");
+                map(static_cast<size_t>(st.st_size));
+                if (std::memcmp(header().magic, snapshot_magic, sizeof(snapshot_magic)) != 0)
+                    throw SnapshotInvalid("Snapshot has unknown format");
+                if (header().version != snapshot_version) throw SnapshotInvalid("Snapshot version mismatch");
+                if (header().session_size != session_size) throw SnapshotInvalid("Snapshot session size mismatch");
+                if (header().session_align != session_align) throw SnapshotInvalid("Snapshot session alignment mismatch");
+                if (latest_area() < 0) throw SnapshotInvalid("Snapshot is incomplete");
+                if (area(latest_area()).slot_count > header().capacity || size_ < record_offset(header().capacity, 0))
+                    throw SnapshotInvalid("Snapshot is truncated");
+            } catch (...) {
+                if (base_) munmap(base_, size_);
+                ::close(fd_);
+                throw;
+            }
+        }
+        SnapshotFile(const SnapshotFile &) = delete;
+        SnapshotFile& operator=(const SnapshotFile &) = delete;
+
+        ~SnapshotFile() {
+            if (base_) munmap(base_, size_);
+            ::close(fd_);
+        }
+
+        /// Grows the file so it holds at least capacity slot records.
+        void reserve(size_t capacity) {
+            if (capacity <= header().capacity) return;
+            map(record_offset(capacity, 0));
+            header().capacity = capacity;
+        }
+
+        /// Writes the header back and waits until it is on disk.
+        void flush_header() {
+            sync(0, sizeof(SnapshotHeader));
+        }
+
+        /// Writes back the pages holding the given records of a copy, indices sorted, and waits until
+        /// they are on disk. Neighbouring records share an msync call.
+        void flush_records(std::span<const uint32_t> indices, unsigned area) {
+            size_t begin = 0, end = 0;
+            for (const uint32_t index : indices) {
+                const size_t offset = record_offset(index, area);
+                if (end && offset / page_size_ > (end - 1) / page_size_ + 1) {
+                    sync(begin, end);
+                    end = 0;
+                }
+                if (!end) begin = offset;
+                end = offset + record_size_;
+            }
+            if (end) sync(begin, end);
+        }
+
+        /// Same as flush_records() for the records [0, count) of a copy.
+        void flush_records(size_t count, unsigned area) {
+            if (count) sync(record_offset(0, area), record_offset(count - 1, area) + record_size_);
+        }
+
+        /// Copy holding the most recent complete snapshot, -1 if there is none.
+        [[nodiscard]] int latest_area() const {
+            int latest = -1;
+            for (unsigned area = 0; area < 2; ++area) {
+                const SnapshotArea & state = header().areas[area];
+                if (state.begin_epoch && state.begin_epoch == state.end_epoch
+                    && (latest < 0 || state.end_epoch > header().areas[latest].end_epoch))
+                    latest = static_cast<int>(area);
+            }
+            return latest;
+        }
+
+        /// Epoch for the next update, past every one started so far.
+        [[nodiscard]] uint64_t next_epoch() const {
+            return std::max(header().areas[0].begin_epoch, header().areas[1].begin_epoch) + 1;
+        }
+
+        [[nodiscard]] SnapshotHeader & header() { return *reinterpret_cast<SnapshotHeader *>(base_); }
+        [[nodiscard]] const SnapshotHeader & header() const { return *reinterpret_cast<const SnapshotHeader *>(base_); }
+        [[nodiscard]] SnapshotArea & area(unsigned area) { return header().areas[area]; }
+        [[nodiscard]] SnapshotSlot & slot(size_t index, unsigned area) {
+            return *reinterpret_cast<SnapshotSlot *>(base_ + record_offset(index, area));
+        }
+        [[nodiscard]] std::byte * payload(size_t index, unsigned area) {
+            return base_ + record_offset(index, area) + payload_offset_;
+        }
+    };
+}
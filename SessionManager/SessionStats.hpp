@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include "../Common/LatencyHistogram.hpp"
+
+namespace Simple {
+    enum class SessionOp : size_t { Create, Lookup, Delete, Count };
+    enum class SessionEvent : size_t { Created, Deleted, Expired, LookupMiss, Full, SlotReused, Count };
+
+    /// Point-in-time view of a manager: event counters, per-operation latencies and occupancy.
+    struct SessionStatsSnapshot {
+        std::array<uint64_t, size_t(SessionEvent::Count)> events{};
+        std::array<LatencyHistogram::Snapshot, size_t(SessionOp::Count)> latencies{};
+        size_t sessions = 0;
+        size_t capacity = 0;
+        size_t slots = 0;      // slots ever allocated, the slot table high-water mark
+        size_t free_slots = 0; // allocated slots waiting for reuse
+
+        [[nodiscard]] uint64_t event(SessionEvent e) const { return events[size_t(e)]; }
+        [[nodiscard]] const LatencyHistogram::Snapshot & latency(SessionOp op) const { return latencies[size_t(op)]; }
+        [[nodiscard]] double occupancy() const { return capacity ? double(sessions) / double(capacity) : 0.0; }
+
+        SessionStatsSnapshot & operator+= (const SessionStatsSnapshot & other) {
+            for (size_t e = 0; e < events.size(); ++e) events[e] += other.events[e];
+            for (size_t op = 0; op < latencies.size(); ++op) latencies[op] += other.latencies[op];
+            sessions += other.sessions;
+            capacity += other.capacity;
+            slots += other.slots;
+            free_slots += other.free_slots;
+            return *this;
+        }
+    };
+
+    /// Default stats policy of SessionManager. Nothing is counted, so the manager offers no stats().
+    struct NullSessionStats {
+        static constexpr const bool enabled = false;
+        struct Timer {};
+        [[nodiscard]] Timer start() const { return {}; }
+        void finish(SessionOp, Timer, uint64_t = 1) const {}
+        void record(SessionEvent, uint64_t = 1) const {}
+    };
+
+    /// Stats policy counting events and timing operations. Counters are relaxed atomics bumped without
+    /// read-modify-write, so the owning manager pays no lock prefix and readers never block it.
+    class SessionStats {
+        mutable std::array<std::atomic_uint64_t, size_t(SessionEvent::Count)> events_{};
+        mutable std::array<LatencyHistogram, size_t(SessionOp::Count)> latencies_{};
+    public:
+        static constexpr const bool enabled = true;
+        using Timer = std::chrono::steady_clock::time_point;
+
+        [[nodiscard]] Timer start() const { return std::chrono::steady_clock::now(); }
+
+        /// Records the time since started as `ops` operations of equal length, for batches.
+        void finish(SessionOp op, Timer started, uint64_t ops = 1) const {
+            if (!ops) return;
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+            latencies_[size_t(op)].record(static_cast<uint64_t>(elapsed.count()) / ops, ops);
+        }
+
+        void record(SessionEvent e, uint64_t times = 1) const {
+            auto & counter = events_[size_t(e)];
+            counter.store(counter.load(std::memory_order_relaxed) + times, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] SessionStatsSnapshot snapshot() const {
+            SessionStatsSnapshot result;
+            for (size_t e = 0; e < result.events.size(); ++e) result.events[e] = events_[e].load(std::memory_order_relaxed);
+            for (size_t op = 0; op < result.latencies.size(); ++op) result.latencies[op] = latencies_[op].snapshot();
+            return result;
+        }
+    };
+}
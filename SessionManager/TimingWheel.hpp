@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+namespace Simple {
+    /// Hierarchical timing wheel keyed by dense integer ids.
+    /// Four levels of 256 buckets cover 2^32 ticks; further deadlines are parked in the top level
+    /// and re-cascaded. Schedule/cancel are O(1), advancing costs O(elapsed ticks + expired timers)
+    /// and never depends on the number of scheduled timers. Allocator (rebound) serves the timer storage.
+    template<typename Allocator = std::allocator<std::byte>>
+    class BasicTimingWheel {
+    public:
+        using Tick = uint64_t;
+    private:
+        static constexpr const uint32_t npos = UINT32_MAX;
+        static constexpr const uint32_t level_bits = 8;
+        static constexpr const uint32_t level_size = 1u << level_bits;
+        static constexpr const uint32_t levels = 4;
+        static constexpr const Tick max_delta = (Tick(1) << (level_bits * levels)) - 1;
+
+        struct Timer {
+            Tick deadline;
+            uint32_t bucket; // npos while not scheduled
+            uint32_t next;
+            uint32_t prev;
+        };
+        std::array<uint32_t, level_size * levels> buckets;
+        std::vector<Timer, typename std::allocator_traits<Allocator>::template rebind_alloc<Timer>> timers; // indexed by id, intrusive bucket lists
+        Tick now_;
+        size_t size_;
+
+        // Timers due before `earliest` are linked into its bucket, the current bucket may already be drained.
+        void link(uint32_t id, Tick earliest) {
+            Timer & timer = timers[id];
+            Tick delta = std::max(timer.deadline, earliest) - now_;
+            Tick when = now_ + std::min(delta, max_delta);
+            uint32_t level = 0;
+            while (level + 1 < levels && delta >= Tick(1) << (level_bits * (level + 1))) ++level;
+            timer.bucket = level * level_size + ((when >> (level_bits * level)) & (level_size - 1));
+            timer.prev = npos;
+            timer.next = std::exchange(buckets[timer.bucket], id);
+            if (timer.next != npos) timers[timer.next].prev = id;
+        }
+
+        void unlink(uint32_t id) {
+            Timer & timer = timers[id];
+            if (timer.prev != npos) timers[timer.prev].next = timer.next;
+            else buckets[timer.bucket] = timer.next;
+            if (timer.next != npos) timers[timer.next].prev = timer.prev;
+            timer.bucket = npos;
+        }
+
+        void cascade(uint32_t level) {
+            uint32_t bucket = level * level_size + ((now_ >> (level_bits * level)) & (level_size - 1));
+            uint32_t id = std::exchange(buckets[bucket], npos);
+            while (id != npos) {
+                uint32_t next = timers[id].next;
+                link(id, now_);
+                id = next;
+            }
+        }
+
+    public:
+        explicit BasicTimingWheel(Tick now = 0, const Allocator & alloc = Allocator())
+            : buckets(), timers(alloc), now_(now), size_(0) {
+            buckets.fill(npos);
+        };
+        explicit BasicTimingWheel(const Allocator & alloc) : BasicTimingWheel(0, alloc) {};
+
+        /// Schedules (or reschedules) the timer identified by id to fire at the given tick.
+        void schedule(uint32_t id, Tick deadline) {
+            if (id >= timers.size()) timers.resize(id + 1, Timer{0, npos, npos, npos});
+            if (timers[id].bucket != npos) unlink(id); else ++size_;
+            timers[id].deadline = deadline;
+            link(id, now_ + 1);
+        }
+
+        /// Removes the timer if it is scheduled, otherwise does nothing.
+        void cancel(uint32_t id) {
+            if (!scheduled(id)) return;
+            unlink(id); --size_;
+        }
+
+        /// Moves the wheel up to the given tick, invoking on_expire(id, tick) for every timer that fires.
+        /// The callback may freely schedule and cancel timers, including the one being fired.
+        template<typename OnExpire>
+        void advance(Tick now, OnExpire && on_expire) {
+            while (now_ < now) {
+                if (!size_) { now_ = now; break; }
+                ++now_;
+                for (uint32_t level = 1; level < levels && !(now_ & ((Tick(1) << (level_bits * level)) - 1)); ++level)
+                    cascade(level);
+                uint32_t & bucket = buckets[now_ & (level_size - 1)];
+                while (bucket != npos) {
+                    uint32_t id = bucket;
+                    unlink(id); --size_;
+                    on_expire(id, now_);
+                }
+            }
+        }
+
+        /// Preallocates bookkeeping for ids below n.
+        void reserve(size_t n) { timers.reserve(n); }
+
+        [[nodiscard]] bool scheduled(uint32_t id) const { return id < timers.size() && timers[id].bucket != npos; }
+        [[nodiscard]] Tick now() const { return now_; }
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] bool empty() const { return !size_; }
+    };
+
+    using TimingWheel = BasicTimingWheel<>;
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <new>
+#include <bit>
+#include <tuple>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include "ConcurrentSignal.hpp"
+
+namespace Simple {
+    constexpr const size_t default_async_capacity = 1024;
+    constexpr const size_t default_async_batch = 64;
+
+    /// What emit_async() does when the queue is full.
+    enum class AsyncOverflow {
+        Block,    // wait for the workers to make room, drop the new event when called from a worker
+        Drop,     // discard the new event
+        Overwrite // discard the oldest queued event
+    };
+
+    template<NothrowVoidInvokable> class AsyncSignal;
+
+    /// ConcurrentSignal that can also emit asynchronously. emit_async() copies the arguments into a bounded
+    /// lock-free ring and returns, a pool of workers drains the ring in batches and invokes the slots.
+    /// With a single worker events are delivered in emission order.
+    template<class R, class... Args>
+    class AsyncSignal<R (Args...)> : public ConcurrentSignal<R (Args...)> {
+        using Event = std::tuple<std::decay_t<Args>...>;
+        static constexpr const size_t npos = SIZE_MAX;
+
+        // Bounded MPMC ring after Dmitry Vyukov: a cell's sequence tells whose turn it is, so producers
+        // and consumers claim cells with a single CAS on their position and never lock.
+        struct alignas(64) Cell {
+            std::atomic_size_t sequence;
+            alignas(Event) std::byte storage[sizeof(Event)];
+            [[nodiscard]] Event * event() { return std::launder(reinterpret_cast<Event*>(storage)); }
+        };
+        // Counter to wait for changes of, notifying costs a system call only while somebody waits
+        struct Beacon {
+            std::atomic_uint32_t value{0};
+            std::atomic_uint32_t waiters{0};
+            [[nodiscard]] uint32_t load() const { return value.load(); }
+            void wait(uint32_t seen) {
+                waiters.fetch_add(1);
+                value.wait(seen);
+                waiters.fetch_sub(1);
+            }
+            void signal() {
+                value.fetch_add(1);
+                if (waiters.load()) value.notify_one();
+            }
+            void broadcast() {
+                value.fetch_add(1);
+                if (waiters.load()) value.notify_all();
+            }
+        };
+
+        const size_t mask_;
+        const std::unique_ptr<Cell[]> cells_;
+        const AsyncOverflow overflow_;
+        const size_t batch_;
+        alignas(64) std::atomic_size_t enqueue_pos_;
+        alignas(64) std::atomic_size_t dequeue_pos_;
+        alignas(64) Beacon published_; // bumped per queued event, idle workers wait on it
+        alignas(64) Beacon progress_;  // bumped per drained batch, flush() and full producers wait on it
+        std::atomic_size_t dropped_;
+        // Per worker: lower bound of the positions it is processing, npos when idle. Lets flush() tell
+        // that every event queued before it has not only been taken but also delivered.
+        const std::unique_ptr<std::atomic_size_t[]> busy_;
+        std::vector<std::jthread> workers_;
+
+        template<class ...Params>
+        [[nodiscard]] bool try_push (Params &&... params) {
+            size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell & cell = cells_[pos & mask_];
+                const auto diff = static_cast<intptr_t>(cell.sequence.load(std::memory_order_acquire) - pos);
+                if (diff == 0) {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        ::new (static_cast<void*>(cell.storage)) Event(std::forward<Params>(params)...);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Moves the oldest event into sink, returns false if there is none ready
+        template<class Sink>
+        [[nodiscard]] bool try_pop (Sink && sink) {
+            size_t pos = dequeue_pos_.load();
+            for (;;) {
+                Cell & cell = cells_[pos & mask_];
+                const auto diff = static_cast<intptr_t>(cell.sequence.load(std::memory_order_acquire) - (pos + 1));
+                if (diff == 0) {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1)) {
+                        sink(std::move(*cell.event()));
+                        cell.event()->~Event();
+                        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = dequeue_pos_.load();
+                }
+            }
+        }
+
+        // Signal whose worker the calling thread is, a worker must never wait for the workers
+        [[nodiscard]] static const AsyncSignal *& worker_of () {
+            static thread_local const AsyncSignal * signal = nullptr;
+            return signal;
+        }
+
+        void work (const std::stop_token & stop, size_t worker) {
+            worker_of() = this;
+            std::vector<Event> batch;
+            batch.reserve(batch_);
+            auto take = [&batch] (Event && event) { batch.push_back(std::move(event)); };
+            for (;;) {
+                const uint32_t seen = published_.load();
+                busy_[worker].store(dequeue_pos_.load());
+                while (batch.size() < batch_ && try_pop(take)) {}
+                if (batch.empty()) {
+                    busy_[worker].store(npos);
+                    if (stop.stop_requested()) return;
+                    published_.wait(seen);
+                    continue;
+                }
+                progress_.broadcast(); // room for blocked producers
+                for (Event & event : batch)
+                    std::apply([this] (auto &... params) { this->emit(static_cast<Args&&>(params)...); }, event);
+                batch.clear();
+                busy_[worker].store(npos);
+                progress_.broadcast();
+            }
+        }
+
+        [[nodiscard]] bool drained (size_t target) const {
+            if (dequeue_pos_.load() < target) return false;
+            for (size_t worker = 0; worker < workers_.size(); ++worker)
+                if (busy_[worker].load() < target) return false;
+            return true;
+        }
+
+    public:
+        /// The queue holds capacity events (rounded up to a power of two), drained by `workers` threads
+        /// which take up to `batch` events at a time.
+        explicit AsyncSignal (size_t capacity = default_async_capacity, size_t workers = 1,
+                              AsyncOverflow overflow = AsyncOverflow::Block, size_t batch = default_async_batch,
+                              const size_t &upper_limit = default_max_callbacks)
+            : ConcurrentSignal<R (Args...)>(upper_limit),
+              mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), cells_(new Cell[mask_ + 1]),
+              overflow_(overflow), batch_(std::max<size_t>(batch, 1)), enqueue_pos_(0), dequeue_pos_(0),
+              published_(), progress_(), dropped_(0), busy_(new std::atomic_size_t[std::max<size_t>(workers, 1)]),
+              workers_() {
+            for (size_t pos = 0; pos <= mask_; ++pos) cells_[pos].sequence.store(pos, std::memory_order_relaxed);
+            workers = std::max<size_t>(workers, 1);
+            for (size_t worker = 0; worker < workers; ++worker) busy_[worker].store(npos);
+            workers_.reserve(workers);
+            for (size_t worker = 0; worker < workers; ++worker)
+                workers_.emplace_back([this, worker] (std::stop_token stop) { work(stop, worker); });
+        }
+
+        /// Delivers every queued event, then stops the workers.
+        ~AsyncSignal () {
+            flush();
+            for (auto & worker : workers_) worker.request_stop();
+            published_.broadcast();
+            workers_.clear();
+        }
+
+        /// Queues a copy of the arguments for the workers and returns.
+        /// Returns false if the event was dropped because the queue was full. With Block, a slot of this
+        /// signal emitting into the full queue would wait for its own worker, so the event is dropped instead.
+        bool emit_async (Args&& ...args) {
+            if (!try_push(std::forward<Args>(args)...)) {
+                switch (overflow_) {
+                    case AsyncOverflow::Block:
+                        if (worker_of() != this) {
+                            for (;;) {
+                                const uint32_t seen = progress_.load();
+                                if (try_push(std::forward<Args>(args)...)) break;
+                                progress_.wait(seen);
+                            }
+                            break;
+                        }
+                        [[fallthrough]];
+                    case AsyncOverflow::Drop:
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    case AsyncOverflow::Overwrite:
+                        do {
+                            if (try_pop([] (Event &&) {})) dropped_.fetch_add(1, std::memory_order_relaxed);
+                        } while (!try_push(std::forward<Args>(args)...));
+                        break;
+                }
+            }
+            published_.signal();
+            return true;
+        }
+
+        /// Waits until every event queued before the call has been delivered to the slots.
+        /// Must not be called from a slot of this signal.
+        void flush () {
+            const size_t target = enqueue_pos_.load();
+            for (;;) {
+                const uint32_t seen = progress_.load();
+                if (drained(target)) return;
+                progress_.wait(seen);
+            }
+        }
+
+        /// Number of events lost to a full queue so far.
+        [[nodiscard]] size_t dropped () const {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+    };
+}
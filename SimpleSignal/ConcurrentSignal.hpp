@@ -0,0 +1,143 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "SimpleSignal.hpp"
+#include "../HPHashMap/HazardPointer.hpp"
+
+namespace Simple {
+    template<NothrowVoidInvokable> class ConcurrentSignal;
+
+    /// Thread-safe signal, any thread may emit, connect and disconnect at any time.
+    /// Emit walks an immutable snapshot of the slots without taking locks or allocating; connect and
+    /// disconnect publish an updated copy under a writer mutex. A replaced snapshot is reclaimed through
+    /// hazard pointers once no emit still walks it, callbacks are freed with the last snapshot holding them.
+    template<class R, class... Args>
+    class ConcurrentSignal<R (Args...)> {
+    protected:
+        using CbFunction = InlineFunction<R (Args...)>;
+    private:
+        struct Entry {
+            uint64_t id;
+            CbFunction callback;
+        };
+        using Snapshot = std::vector<std::shared_ptr<const Entry>>;
+
+        std::atomic<Snapshot*> snapshot_;
+        std::mutex writer_mtx_;
+        uint64_t next_id_;
+        const size_t upper_limit_;
+
+        using Protection = HazardDomain<>::Guard;
+
+        // Publishes the new snapshot, the caller must hold writer_mtx_
+        void publish (Snapshot * snapshot) {
+            HazardDomain<>::Retire(snapshot_.exchange(snapshot));
+        }
+
+    public:
+        class SlotHandle {
+            uint64_t id_;
+            explicit SlotHandle (uint64_t id)
+                : id_(id) {
+            };
+        public:
+            SlotHandle ()                       = delete;
+            SlotHandle (SlotHandle &&) noexcept = default;
+            SlotHandle (const SlotHandle&)      = default;
+            SlotHandle& operator= (SlotHandle&&) noexcept = default;
+            SlotHandle& operator= (const SlotHandle&)     = default;
+            friend ConcurrentSignal<R (Args...)>;
+        };
+
+        class SlotInvalid : std::exception {
+            std::string e;
+            explicit SlotInvalid (std::string reason)
+                : e(std::move(reason)) {
+            };
+        public:
+            SlotInvalid ()                   = delete;
+            SlotInvalid (SlotInvalid&&)      = delete;
+            SlotInvalid (const SlotInvalid&) = delete;
+            [[nodiscard]] const char * what() const noexcept override {
+                return e.c_str();
+            }
+            friend ConcurrentSignal<R (Args...)>;
+        };
+
+        explicit ConcurrentSignal (const size_t &upper_limit = default_max_callbacks)
+            : snapshot_(new Snapshot()), writer_mtx_(), next_id_(0), upper_limit_(upper_limit) {
+        }
+        ConcurrentSignal (ConcurrentSignal&&)            = delete;
+        ConcurrentSignal& operator= (ConcurrentSignal&&) = delete;
+        ConcurrentSignal (const ConcurrentSignal&)            = delete;
+        ConcurrentSignal& operator= (const ConcurrentSignal&) = delete;
+
+        /// No thread may emit while the signal is being destroyed.
+        ~ConcurrentSignal () {
+            delete snapshot_.load();
+        }
+
+        /// Adds a new slot, visible to every emit that starts after connect returns.
+        [[nodiscard]] SlotHandle connect (CbFunction && cbf) {
+            std::lock_guard lock(writer_mtx_);
+            const Snapshot & current = *snapshot_.load(std::memory_order_relaxed);
+            if (current.size() >= upper_limit_) throw SlotInvalid("Run out of slots");
+            auto updated = std::make_unique<Snapshot>();
+            updated->reserve(current.size() + 1);
+            *updated = current;
+            updated->push_back(std::make_shared<const Entry>(Entry{++next_id_, std::move(cbf)}));
+            publish(updated.release());
+            return SlotHandle(next_id_);
+        }
+
+        /// Connects a function known at compile time, emit calls it without any type erasure.
+        template<auto Function>
+        [[nodiscard]] SlotHandle connect () {
+            return connect(CbFunction::template bind<Function>());
+        }
+
+        template<class Instance, class Class>
+        [[nodiscard]] SlotHandle connect_slot (Instance &object, R (Class::*method) (Args...)) {
+            return connect([&object, method] (Args... args) { return (object .* method) (args...); });
+        }
+
+        template<class Class>
+        [[nodiscard]] SlotHandle connect_slot (Class *object, R (Class::*method) (Args...)) {
+            return connect([object, method] (Args... args) { return (object ->* method) (args...); });
+        }
+
+        /// Removes a slot through its handle, throws if no such slot. Emits already running may still call it.
+        void disconnect (const SlotHandle & slot_handle) {
+            std::lock_guard lock(writer_mtx_);
+            const Snapshot & current = *snapshot_.load(std::memory_order_relaxed);
+            auto found = std::find_if(current.begin(), current.end(),
+                                      [&slot_handle] (const auto & entry) { return entry->id == slot_handle.id_; });
+            if (found == current.end()) throw SlotInvalid("No such slot");
+            auto updated = std::make_unique<Snapshot>();
+            updated->reserve(current.size() - 1);
+            updated->insert(updated->end(), current.begin(), found);
+            updated->insert(updated->end(), std::next(found), current.end());
+            publish(updated.release());
+        }
+
+        /// Invokes every slot connected when the call started. Takes no locks and never waits for writers.
+        /// Slots may connect and disconnect, on this signal as well, while they run.
+        void emit (Args&& ...args) const {
+            Protection protection;
+            for (const auto & entry : *protection.Protect(snapshot_))
+                entry->callback(std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] std::size_t size () const {
+            Protection protection;
+            return protection.Protect(snapshot_)->size();
+        }
+    };
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+namespace Simple {
+    constexpr const size_t default_inline_capacity = 4 * sizeof(void*);
+
+    template<class Signature, size_t Capacity = default_inline_capacity> class InlineFunction;
+
+    /// Move-only callable wrapper keeping targets of up to Capacity bytes inline, larger ones on the heap.
+    /// A call is a single indirect jump into a thunk that has the target inlined. Trivially copyable targets
+    /// (function pointers, member binders, lambdas capturing references) need no manager at all.
+    template<class R, class... Args, size_t Capacity>
+    class InlineFunction<R (Args...), Capacity> {
+        enum class Op { Move, Destroy };
+        using Invoker = R (*) (void *, Args&&...);
+        using Manager = void (*) (Op, void *, void *);
+
+        alignas(std::max_align_t) mutable std::byte storage_[Capacity];
+        Invoker invoke_;
+        Manager manage_; // moves or destroys the target, nullptr when memcpy will do
+
+        template<class T>
+        static constexpr const bool is_inline = sizeof(T) <= Capacity && alignof(T) <= alignof(std::max_align_t)
+                                                && std::is_nothrow_move_constructible_v<T>;
+
+        // Null function pointers and empty std::functions produce an empty wrapper
+        template<class F, class T = std::decay_t<F>>
+        static constexpr const bool may_be_empty = std::is_member_pointer_v<T> || std::is_same_v<T, std::function<R (Args...)>>
+                                                   || (std::is_pointer_v<T> && !std::is_function_v<std::remove_reference_t<F>>);
+
+        template<class T>
+        static R invoke_inline (void * storage, Args&&... args) {
+            return std::invoke(*static_cast<T*>(storage), std::forward<Args>(args)...);
+        }
+
+        template<class T>
+        static R invoke_heap (void * storage, Args&&... args) {
+            return std::invoke(**static_cast<T**>(storage), std::forward<Args>(args)...);
+        }
+
+        template<auto Function>
+        static R invoke_bound (void *, Args&&... args) {
+            return std::invoke(Function, std::forward<Args>(args)...);
+        }
+
+        template<auto Method, class Class>
+        static R invoke_member (void * storage, Args&&... args) {
+            return std::invoke(Method, *static_cast<Class**>(storage), std::forward<Args>(args)...);
+        }
+
+        // Move relocates the target from src into dst, both operations leave src destroyed
+        template<class T>
+        static void manage_inline (Op op, void * dst, void * src) {
+            if (op == Op::Move) ::new (dst) T(std::move(*static_cast<T*>(src)));
+            static_cast<T*>(src)->~T();
+        }
+
+        template<class T>
+        static void manage_heap (Op op, void * dst, void * src) {
+            if (op == Op::Move) std::memcpy(dst, src, sizeof(T*));
+            else delete *static_cast<T**>(src);
+        }
+
+    public:
+        InlineFunction () noexcept : invoke_(nullptr), manage_(nullptr) {};
+        InlineFunction (std::nullptr_t) noexcept : InlineFunction() {};
+
+        template<class F, class T = std::decay_t<F>>
+            requires (!std::is_same_v<T, InlineFunction> && std::is_invocable_r_v<R, T&, Args...>)
+        InlineFunction (F && target) : InlineFunction() {
+            if constexpr (may_be_empty<F>)
+                if (!static_cast<bool>(target)) return;
+            if constexpr (is_inline<T>) {
+                ::new (static_cast<void*>(storage_)) T(std::forward<F>(target));
+                if constexpr (!std::is_trivially_copyable_v<T>) manage_ = &manage_inline<T>;
+                invoke_ = &invoke_inline<T>;
+            } else {
+                T * heap_target = new T(std::forward<F>(target));
+                std::memcpy(storage_, &heap_target, sizeof(heap_target));
+                manage_ = &manage_heap<T>;
+                invoke_ = &invoke_heap<T>;
+            }
+        }
+
+        /// Wraps a function known at compile time, the call is resolved statically inside the thunk.
+        template<auto Function>
+        [[nodiscard]] static InlineFunction bind () noexcept {
+            InlineFunction result;
+            result.invoke_ = &invoke_bound<Function>;
+            return result;
+        }
+
+        /// Wraps a member function known at compile time together with the object it is called on.
+        template<auto Method, class Class>
+        [[nodiscard]] static InlineFunction bind (Class * object) noexcept {
+            InlineFunction result;
+            std::memcpy(result.storage_, &object, sizeof(object));
+            result.invoke_ = &invoke_member<Method, Class>;
+            return result;
+        }
+
+        InlineFunction (InlineFunction && other) noexcept : invoke_(other.invoke_), manage_(other.manage_) {
+            if (manage_) manage_(Op::Move, storage_, other.storage_);
+            else if (invoke_) std::memcpy(storage_, other.storage_, Capacity);
+            other.invoke_ = nullptr;
+            other.manage_ = nullptr;
+        }
+
+        InlineFunction& operator= (InlineFunction && other) noexcept {
+            if (this == &other) return *this;
+            reset();
+            invoke_ = std::exchange(other.invoke_, nullptr);
+            manage_ = std::exchange(other.manage_, nullptr);
+            if (manage_) manage_(Op::Move, storage_, other.storage_);
+            else if (invoke_) std::memcpy(storage_, other.storage_, Capacity);
+            return *this;
+        }
+
+        InlineFunction (const InlineFunction&)            = delete;
+        InlineFunction& operator= (const InlineFunction&) = delete;
+
+        ~InlineFunction () {
+            reset();
+        }
+
+        /// Destroys the target, leaving the wrapper empty.
+        void reset () noexcept {
+            if (manage_) manage_(Op::Destroy, nullptr, storage_);
+            invoke_ = nullptr;
+            manage_ = nullptr;
+        }
+
+        /// Calls the target, throws std::bad_function_call if there is none.
+        R operator() (Args... args) const {
+            if (!invoke_) [[unlikely]] throw std::bad_function_call();
+            return invoke_(storage_, std::forward<Args>(args)...);
+        }
+
+        /// True if the wrapper holds a target.
+        explicit operator bool () const noexcept {
+            return invoke_ != nullptr;
+        }
+    };
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <mutex>
+#include <array>
+#include <bit>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../Common/LatencyHistogram.hpp"
+
+namespace Simple {
+    /// Default profiling policy of Signal. Emits read no clock, and the profile queries of the signal are unavailable.
+    struct NullSignalProfiler {
+        static constexpr const bool enabled = false;
+        struct Timer {};
+        [[nodiscard]] Timer start() const { return {}; }
+        Timer slot_called(uint32_t, uint32_t, Timer) const { return {}; }
+        void emitted(Timer, Timer) const {}
+    };
+
+    /// Profiling policy timing every slot call and every emit. Each thread records into a buffer of its
+    /// own, so emitting threads share no cache lines and take no locks except when a slot is seen first.
+    /// Slots are keyed by their slot table index and generation, the key a SlotHandle carries.
+    /// A slot's finish time doubles as the next slot's start time, so an emit reads the clock once per slot.
+    class SignalProfiler {
+        struct SlotRecord {
+            uint32_t generation;
+            LatencyHistogram latencies;
+        };
+        struct Buffer {
+            std::mutex mtx; // guards the slots layout, the owning thread only takes it to add a record
+            std::vector<std::unique_ptr<SlotRecord>> slots; // by slot table index
+            LatencyHistogram emits;
+        };
+        struct State {
+            std::mutex mtx;
+            std::vector<std::unique_ptr<Buffer>> buffers;
+            // Buffers by thread index, segment s holds 2^s threads so published segments never move
+            std::array<std::atomic<Buffer **>, 64> segments{};
+
+            State () = default;
+            State (const State&) = delete;
+            State& operator= (const State&) = delete;
+            ~State () { for (auto & segment : segments) delete[] segment.load(std::memory_order_relaxed); }
+        };
+        std::unique_ptr<State> state_;
+
+        [[nodiscard]] static uint64_t elapsed (std::chrono::steady_clock::time_point started,
+                                               std::chrono::steady_clock::time_point finished) {
+            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started);
+            return static_cast<uint64_t>(nanos.count());
+        }
+
+        // Dense index of the calling thread, handed back for reuse when the thread exits. A thread reusing
+        // an index inherits the buffer of the thread that left, the registry lock orders the two.
+        [[nodiscard]] static size_t thread_index () {
+            struct Registry {
+                std::mutex mtx;
+                size_t next = 0;
+                std::vector<size_t> released;
+            };
+            static Registry & registry = *new Registry; // outlives threads exiting after main
+            struct Index {
+                size_t value;
+                Index () {
+                    std::lock_guard lock(registry.mtx);
+                    if (registry.released.empty()) value = registry.next++;
+                    else {
+                        value = registry.released.back();
+                        registry.released.pop_back();
+                    }
+                }
+                ~Index () {
+                    std::lock_guard lock(registry.mtx);
+                    registry.released.push_back(value);
+                }
+            };
+            static thread_local const Index index;
+            return index.value;
+        }
+
+        // The calling thread's buffer. Only the thread holding an index reads or writes its entry, so
+        // finding the buffer takes no lock, only creating it or its segment does.
+        [[nodiscard]] Buffer & local () const {
+            const size_t index = thread_index() + 1;
+            const auto segment = static_cast<size_t>(std::bit_width(index) - 1);
+            const size_t offset = index - (size_t(1) << segment);
+            Buffer ** buffers = state_->segments[segment].load(std::memory_order_acquire);
+            if (buffers && buffers[offset]) return *buffers[offset];
+            std::lock_guard lock(state_->mtx);
+            buffers = state_->segments[segment].load(std::memory_order_relaxed);
+            if (!buffers) {
+                buffers = new Buffer * [size_t(1) << segment]();
+                state_->segments[segment].store(buffers, std::memory_order_release);
+            }
+            buffers[offset] = state_->buffers.emplace_back(std::make_unique<Buffer>()).get();
+            return *buffers[offset];
+        }
+
+    public:
+        static constexpr const bool enabled = true;
+        using Timer = std::chrono::steady_clock::time_point;
+
+        SignalProfiler () : state_(std::make_unique<State>()) {}
+        SignalProfiler (SignalProfiler&&) noexcept            = default;
+        SignalProfiler& operator= (SignalProfiler&&) noexcept = default;
+
+        [[nodiscard]] Timer start() const { return std::chrono::steady_clock::now(); }
+
+        /// Records a slot call that started at the given time, returns the time it finished.
+        Timer slot_called(uint32_t index, uint32_t generation, Timer started) const {
+            const Timer finished = std::chrono::steady_clock::now();
+            if (!state_) return finished; // moved from
+            Buffer & buffer = local();
+            if (index >= buffer.slots.size() || !buffer.slots[index] || buffer.slots[index]->generation != generation) {
+                auto record = std::make_unique<SlotRecord>();
+                record->generation = generation;
+                std::lock_guard lock(buffer.mtx);
+                if (index >= buffer.slots.size()) buffer.slots.resize(index + 1);
+                buffer.slots[index] = std::move(record);
+            }
+            buffer.slots[index]->latencies.record(elapsed(started, finished));
+            return finished;
+        }
+
+        void emitted(Timer started, Timer finished) const {
+            if (state_) local().emits.record(elapsed(started, finished));
+        }
+
+        /// Latencies of all calls to the slot, merged over every thread. The count is the number of calls.
+        [[nodiscard]] LatencyHistogram::Snapshot slot(uint32_t index, uint32_t generation) const {
+            LatencyHistogram::Snapshot result;
+            if (!state_) return result;
+            std::lock_guard lock(state_->mtx);
+            for (const auto & buffer : state_->buffers) {
+                std::lock_guard buffer_lock(buffer->mtx);
+                if (index < buffer->slots.size() && buffer->slots[index] && buffer->slots[index]->generation == generation)
+                    result += buffer->slots[index]->latencies.snapshot();
+            }
+            return result;
+        }
+
+        /// Latencies of whole emits, merged over every thread.
+        [[nodiscard]] LatencyHistogram::Snapshot emits() const {
+            LatencyHistogram::Snapshot result;
+            if (!state_) return result;
+            std::lock_guard lock(state_->mtx);
+            for (const auto & buffer : state_->buffers) result += buffer->emits.snapshot();
+            return result;
+        }
+    };
+}
@@ -2,42 +2,148 @@
 
 #include <functional>
 #include <string>
+#include <span>
+#include <tuple>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <ostream>
+#include <algorithm>
+#include "InlineFunction.hpp"
+#include "SmallVector.hpp"
+#include "../Common/WorkStealingPool.hpp"
+#include "SignalProfiler.hpp"
 
 namespace Simple {
     constexpr const size_t default_max_callbacks = 1000;
+    constexpr const size_t default_inline_slots = 2;
+    constexpr const size_t default_parallel_threshold = 64;
 
     template<class R, class... Args> concept NothrowVoidInvokable = requires {
         std::is_nothrow_invocable_v<R, Args...>; std::is_void_v<R>;
-    }; template<NothrowVoidInvokable> class Signal;
+    }; template<NothrowVoidInvokable, size_t InlineSlots = default_inline_slots, class Profiler = NullSignalProfiler,
+             class Allocator = std::allocator<std::byte>> class Signal;
 
-    /// Signal template specialised for the callback signature
-    template<class R, class... Args>
-    class Signal<R (Args...)> {
+    /// Signal template specialised for the callback signature.
+    /// The first InlineSlots slots live inside the signal object itself, so small signals never allocate.
+    /// Profiler = SignalProfiler times every slot call of emit() and emit_parallel(), the default compiles it out.
+    /// Allocator (rebound as needed) serves the slot storage that doesn't fit inline.
+    template<class R, class... Args, size_t InlineSlots, class Profiler, class Allocator>
+    class Signal<R (Args...), InlineSlots, Profiler, Allocator> {
+    public:
+        /// One emission worth of arguments, emit_batch() takes a span of these.
+        using Event = std::tuple<Args...>;
+        using allocator_type = Allocator;
     protected:
-        using CbFunction = std::function<R (Args...)>;
+        using CbFunction = InlineFunction<R (Args...)>;
+        using BatchFunction = InlineFunction<R (std::span<const Event>)>;
     private:
-        std::pair<void*,void*> margins_;
-        void ** free_beg_;
-        size_t size_;
+        // A slot handle holds the slot table index and the slot generation. Every connect draws a fresh
+        // generation, so handles of disconnected slots (and of other signals) no longer resolve.
+        static constexpr const uint32_t npos = UINT32_MAX;
+        static constexpr const uint32_t batch_flag = 1u << 31; // set in links into the batch handler arrays
+        template<class T> using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+        struct Slot {
+            uint32_t generation;
+            uint32_t link; // dense index while connected, next free slot otherwise
+        };
+        SmallVector<CbFunction, InlineSlots, Rebind<CbFunction>> callbacks_; // stored by value, densely packed, swap-removed on disconnect
+        SmallVector<uint32_t, InlineSlots, Rebind<uint32_t>> owners_;        // dense index -> slot index
+        SmallVector<Slot, InlineSlots, Rebind<Slot>> slots_;
+        std::vector<BatchFunction, Rebind<BatchFunction>> batch_callbacks_; // native batch handlers are rare, kept out of the inline storage
+        std::vector<uint32_t, Rebind<uint32_t>> batch_owners_;
+        uint32_t free_head_;
+        uint32_t upper_limit_;
+        [[no_unique_address]] Profiler profiler_;
+
+        [[nodiscard]] static uint32_t next_generation () {
+            static std::atomic_uint32_t generation(0);
+            return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        [[nodiscard]] bool is_connected (uint32_t index) const {
+            const uint32_t link = slots_[index].link;
+            if (link & batch_flag)
+                return (link & ~batch_flag) < batch_owners_.size() && batch_owners_[link & ~batch_flag] == index;
+            return link < owners_.size() && owners_[link] == index;
+        }
+
+        // Makes room for one more element (growing geometrically), so the push_back that follows can't throw
+        template<class Vector>
+        static void reserve_one (Vector & vector) {
+            if (vector.size() == vector.capacity()) vector.reserve(std::max<size_t>(vector.capacity() * 2, 1));
+        }
+
+        // Grows everything a connect to the given dense arrays pushes into except the callbacks, which are
+        // pushed last: a failing allocation then leaves the signal as it was
+        template<class Owners>
+        void reserve_connect (Owners & owners) {
+            reserve_one(owners);
+            if (free_head_ == npos) reserve_one(slots_);
+        }
+
+        // Points a free slot table entry (or a new one) at the given dense position, returns its index
+        [[nodiscard]] uint32_t claim_slot (uint32_t link) {
+            uint32_t index = free_head_;
+            if (index != npos) {
+                free_head_ = slots_[index].link;
+            } else {
+                index = static_cast<uint32_t>(slots_.size());
+                slots_.push_back({0, 0});
+            }
+            slots_[index] = {next_generation(), link};
+            return index;
+        }
 
-        [[nodiscard]] inline bool is_inside_buff(const void * cb_ptr) const {
-            return cb_ptr >= margins_.first && cb_ptr < margins_.second;
+        // Runs one slot call that started at the given time, timed when profiling. Returns when it finished.
+        template<class Call>
+        auto profile (uint32_t index, Call && call, typename Profiler::Timer started) const {
+            call();
+            return profiler_.slot_called(index, slots_[index].generation, started);
+        }
+
+        // Hands one emit's arguments to the batch handlers as a batch of one, returns when the last one finished.
+        // Only signals whose arguments can be copied into an Event have batch handlers.
+        typename Profiler::Timer emit_to_batch_handlers (typename Profiler::Timer finished, const Args & ...args) const
+            requires std::is_copy_constructible_v<Event> {
+            const Event event(args...);
+            for (size_t dense = 0; dense < batch_callbacks_.size(); ++dense)
+                finished = profile(batch_owners_[dense], [&] {
+                    batch_callbacks_[dense](std::span<const Event>(&event, 1));
+                }, finished);
+            return finished;
+        }
+
+        // Moves the last entry of the dense arrays into the given position and drops the last one
+        template<class Callbacks, class Owners>
+        void remove_dense (Callbacks & callbacks, Owners & owners, uint32_t dense, uint32_t flag) {
+            if (dense != callbacks.size() - 1) {
+                callbacks[dense] = std::move(callbacks.back());
+                owners[dense] = owners.back();
+                slots_[owners[dense]].link = dense | flag;
+            }
+            callbacks.pop_back();
+            owners.pop_back();
         }
 
     public:
         class SlotHandle {
-            const void ** handle_;
-            explicit SlotHandle (void ** handle)
-                : handle_(const_cast<const void **>(handle)) {
+            uint32_t index_;
+            uint32_t generation_;
+            SlotHandle (uint32_t index, uint32_t generation)
+                : index_(index), generation_(generation) {
             };
-            [[nodiscard]] void ** get_handle () const { return const_cast<void**>(handle_); };
         public:
             SlotHandle ()                       = delete;
             SlotHandle (SlotHandle &&) noexcept = default;
             SlotHandle (const SlotHandle&)      = default;
             SlotHandle& operator= (SlotHandle&&) noexcept = default;
             SlotHandle& operator= (const SlotHandle&)     = default;
-            friend Signal<R (Args...)>;
+            friend Signal;
         };
 
         class SlotInvalid : std::exception {
@@ -52,82 +158,189 @@ namespace Simple {
             [[nodiscard]] const char * what() const noexcept override {
                 return e.c_str();
             }
-            friend Signal<R (Args...)>;
+            friend Signal;
         };
 
         /// Signal constructor, connects default callback if given.
-        explicit Signal (const size_t &upper_limit = default_max_callbacks, CbFunction && method = CbFunction())
-            : margins_(nullptr, nullptr), free_beg_(new void*[upper_limit+1]), size_(0) {
-            margins_.first = free_beg_;
-            for (size_t i = 0; i < upper_limit; ++i)
-                free_beg_[i] = static_cast<void*>(&free_beg_[i + 1]);
-            free_beg_[upper_limit] = nullptr;
-            margins_.second = free_beg_ + upper_limit + 1;
+        /// Live callbacks are kept contiguous, so emit only ever touches connected slots. Storage grows
+        /// geometrically as slots are connected, upper_limit only caps the number of slots.
+        explicit Signal (const size_t &upper_limit = default_max_callbacks, CbFunction && method = CbFunction(),
+                         const Allocator & alloc = Allocator())
+            : callbacks_(alloc), owners_(alloc), slots_(alloc), batch_callbacks_(alloc), batch_owners_(alloc), free_head_(npos),
+              upper_limit_(static_cast<uint32_t>(std::min<size_t>(upper_limit, batch_flag))), profiler_() {
             if (method) static_cast<void>(connect(std::move(method)));
         }
-        Signal (Signal&&) noexcept            = default;
-        Signal& operator= (Signal&&) noexcept = default;
+        /// Moves the slots over, handles stay valid with the new signal. The source is left empty and usable.
+        Signal (Signal && other) noexcept
+            : callbacks_(std::move(other.callbacks_)), owners_(std::move(other.owners_)), slots_(std::move(other.slots_)),
+              batch_callbacks_(std::move(other.batch_callbacks_)), batch_owners_(std::move(other.batch_owners_)),
+              free_head_(std::exchange(other.free_head_, npos)), upper_limit_(other.upper_limit_),
+              profiler_(std::move(other.profiler_)) {
+        }
+        Signal& operator= (Signal && other) noexcept(std::allocator_traits<Allocator>::is_always_equal::value ||
+                                                     std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+            if (this != &other) {
+                callbacks_ = std::move(other.callbacks_);
+                owners_ = std::move(other.owners_);
+                slots_ = std::move(other.slots_);
+                batch_callbacks_ = std::move(other.batch_callbacks_);
+                batch_owners_ = std::move(other.batch_owners_);
+                other.batch_callbacks_.clear(); // a move between unequal allocators leaves the elements behind
+                other.batch_owners_.clear();
+                free_head_ = std::exchange(other.free_head_, npos);
+                upper_limit_ = other.upper_limit_;
+                profiler_ = std::move(other.profiler_);
+            }
+            return *this;
+        }
 
         Signal (const Signal&)            = delete;
         Signal& operator= (const Signal&) = delete;
 
         /// Signal destructor releases all resources associated with this signal.
-        ~Signal () {
-            size_t left = size_;
-            void ** cb_ptr = static_cast<void**>(margins_.first);
-            while (left && cb_ptr < static_cast<void**>(margins_.second)) {
-                if (*cb_ptr && !is_inside_buff(*cb_ptr)) {
-                    delete reinterpret_cast<CbFunction*>(*cb_ptr); --left;
-                }
-                ++cb_ptr;
-            }
-            delete [] static_cast<void**>(margins_.first);
-        };
+        ~Signal () = default;
 
         /// Operator to add a new slot, returns a handler.
         [[nodiscard]] SlotHandle connect (CbFunction && cbf) {
-            if (!free_beg_ || !*free_beg_) throw SlotInvalid("Run out of slots");
-            void** cbf_ptr = std::exchange(free_beg_, static_cast<void**>(*free_beg_));
-            *cbf_ptr = new CbFunction(cbf); ++size_;
-            return SlotHandle(cbf_ptr);
+            if (size() >= upper_limit_) throw SlotInvalid("Run out of slots");
+            reserve_connect(owners_);
+            callbacks_.push_back(std::move(cbf));
+            const uint32_t index = claim_slot(static_cast<uint32_t>(callbacks_.size() - 1));
+            owners_.push_back(index);
+            return SlotHandle(index, slots_[index].generation);
+        }
+
+        /// Adds a slot handling a whole batch of events in one call, e.g. to vectorize its work.
+        /// emit() hands it a batch of one event.
+        [[nodiscard]] SlotHandle connect_batch (BatchFunction && bf) requires std::is_copy_constructible_v<Event> {
+            if (size() >= upper_limit_) throw SlotInvalid("Run out of slots");
+            reserve_connect(batch_owners_);
+            batch_callbacks_.push_back(std::move(bf));
+            const uint32_t index = claim_slot(static_cast<uint32_t>(batch_callbacks_.size() - 1) | batch_flag);
+            batch_owners_.push_back(index);
+            return SlotHandle(index, slots_[index].generation);
+        }
+
+        /// Connects a function known at compile time, emit calls it without any type erasure.
+        template<auto Function>
+        [[nodiscard]] SlotHandle connect () {
+            return connect(CbFunction::template bind<Function>());
         }
 
-        /// This function connects an std::function binding to the object member function pointer
+        /// This function connects an inline binding to the object member function pointer
         template<class Instance, class Class>
         [[nodiscard]] SlotHandle connect_slot (Instance &object, R (Class::*method) (Args...)) {
             return connect([&object, method] (Args... args) { return (object .* method) (args...); });
         }
 
-        /// This function connects an std::function binding to the object member function pointer
+        /// This function connects an inline binding to the object member function pointer
         template<class Class>
         [[nodiscard]] SlotHandle connect_slot (Class *object, R (Class::*method) (Args...)) {
             return connect([object, method] (Args... args) { return (object ->* method) (args...); });
         }
 
+        /// Connects a member function known at compile time, called directly on the object.
+        template<auto Method, class Class>
+        [[nodiscard]] SlotHandle connect_slot (Class &object) {
+            return connect(CbFunction::template bind<Method>(&object));
+        }
+
+        /// Connects a member function known at compile time, called directly on the object.
+        template<auto Method, class Class>
+        [[nodiscard]] SlotHandle connect_slot (Class *object) {
+            return connect(CbFunction::template bind<Method>(object));
+        }
+
         /// Operator to removes a slot through its handle, throws if no such slot.
+        /// The last callback is moved into the freed position, handles of other slots stay valid.
         void disconnect (const SlotHandle & slot_handle) {
-            void ** cbf_ptr = slot_handle.get_handle();
-            if (!cbf_ptr  || !is_inside_buff(cbf_ptr) || !*cbf_ptr || is_inside_buff(*cbf_ptr))
+            const uint32_t index = slot_handle.index_;
+            if (index >= slots_.size() || slots_[index].generation != slot_handle.generation_ || !is_connected(index))
                 throw SlotInvalid("No such slot");
-            delete reinterpret_cast<CbFunction*>(*cbf_ptr);
-            *cbf_ptr = std::exchange(*free_beg_, cbf_ptr); --size_;
+            const uint32_t link = slots_[index].link;
+            if (link & batch_flag) remove_dense(batch_callbacks_, batch_owners_, link & ~batch_flag, batch_flag);
+            else remove_dense(callbacks_, owners_, link, 0);
+            slots_[index].link = std::exchange(free_head_, index);
         }
 
         /// Emit a signal, i.e. invoke all its callbacks.
         void emit (Args&& ...args) const {
-            size_t left = size_;
-            void ** cb_ptr = static_cast<void**>(margins_.first);
-            while (left && cb_ptr < static_cast<void**>(margins_.second)) {
-                if (*cb_ptr && !is_inside_buff(*cb_ptr)) {
-                    reinterpret_cast<CbFunction*>(*cb_ptr)->operator()(std::forward<Args>(args)...);
-                    --left;
-                }
-                ++cb_ptr;
-            }
+            const auto started = profiler_.start();
+            auto finished = started;
+            if constexpr (std::is_copy_constructible_v<Event>)
+                if (!batch_callbacks_.empty()) finished = emit_to_batch_handlers(finished, args...);
+            for (size_t dense = 0; dense < callbacks_.size(); ++dense)
+                finished = profile(owners_[dense], [&] { callbacks_[dense](std::forward<Args>(args)...); }, finished);
+            profiler_.emitted(started, finished);
+        }
+
+        /// Invokes the slots spread over the threads of the pool, returns once all of them returned.
+        /// Signals with fewer than threshold slots emit serially, below that the fan-out costs more than it gains.
+        /// Every slot gets its own copy of by value arguments, slots must tolerate running concurrently.
+        void emit_parallel (WorkStealingPool & pool, size_t threshold, Args&& ...args) const
+            requires std::is_copy_constructible_v<Event> {
+            if (size() < threshold || pool.workers() == 0) return emit(std::forward<Args>(args)...);
+            const auto started = profiler_.start();
+            const Event event(args...);
+            const size_t batches = batch_callbacks_.size();
+            pool.run(size(), [&] (size_t i) {
+                if (i < batches)
+                    profile(batch_owners_[i], [&] { batch_callbacks_[i](std::span<const Event>(&event, 1)); },
+                            profiler_.start());
+                else profile(owners_[i - batches], [&] {
+                    std::apply([&cbf = callbacks_[i - batches]] (auto &... params) { cbf(params...); }, event);
+                }, profiler_.start());
+            });
+            profiler_.emitted(started, profiler_.start());
+        }
+
+        /// emit_parallel() on the shared pool with the default threshold.
+        void emit_parallel (Args&& ...args) const requires std::is_copy_constructible_v<Event> {
+            emit_parallel(WorkStealingPool::shared(), default_parallel_threshold, std::forward<Args>(args)...);
+        }
+
+        /// Emits every event of the batch, slot by slot: each slot runs over the whole batch before the next
+        /// one starts, so its code and captured state stay hot. Every slot sees the events in order.
+        void emit_batch (std::span<const Event> events) const requires std::is_copy_constructible_v<Event> {
+            for (const BatchFunction & bf : batch_callbacks_) bf(events);
+            for (const CbFunction & cbf : callbacks_)
+                for (const Event & event : events)
+                    std::apply([&cbf] (auto &... params) { cbf(params...); }, event);
         }
 
         [[nodiscard]] std::size_t size () const {
-            return size_;
+            return callbacks_.size() + batch_callbacks_.size();
+        }
+
+        [[nodiscard]] allocator_type get_allocator () const {
+            return allocator_type(callbacks_.get_allocator());
+        }
+
+        /// Latencies of the calls to one slot over all threads, the count is the number of calls.
+        /// A disconnected slot keeps its profile until a new slot takes over its slot table entry.
+        [[nodiscard]] LatencyHistogram::Snapshot slot_profile (const SlotHandle & slot_handle) const requires Profiler::enabled {
+            return profiler_.slot(slot_handle.index_, slot_handle.generation_);
+        }
+
+        /// Latencies of whole emits over all threads.
+        [[nodiscard]] LatencyHistogram::Snapshot emit_profile () const requires Profiler::enabled {
+            return profiler_.emits();
+        }
+
+        /// Writes a line per connected slot, slots are named by slot table index and generation.
+        void dump_profile (std::ostream & out) const requires Profiler::enabled {
+            auto line = [&out] (const LatencyHistogram::Snapshot & latencies) {
+                out << " calls " << latencies.count() << " p50 " << latencies.percentile(0.5) << "ns p99 "
+                    << latencies.percentile(0.99) << "ns max " << latencies.percentile(1.0) << "ns\n";
+            };
+            out << "emit";
+            line(profiler_.emits());
+            for (const auto & owners : {std::span<const uint32_t>(owners_.begin(), owners_.end()),
+                                        std::span<const uint32_t>(batch_owners_)})
+                for (const uint32_t index : owners) {
+                    out << "slot " << index << '#' << slots_[index].generation;
+                    line(profiler_.slot(index, slots_[index].generation));
+                }
         }
     };
 }
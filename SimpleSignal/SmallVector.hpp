@@ -0,0 +1,127 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace Simple {
+    /// Minimal vector keeping up to N elements inline, it moves to the heap (growing geometrically) only
+    /// beyond that, allocating through Allocator. Elements must be nothrow move constructible, a move
+    /// leaves the source empty.
+    template<class T, size_t N, class Allocator = std::allocator<T>>
+    class SmallVector {
+        static_assert(std::is_nothrow_move_constructible_v<T>);
+        static_assert(N > 0 && N < UINT32_MAX);
+        using Traits = std::allocator_traits<Allocator>;
+
+        [[no_unique_address]] Allocator alloc_;
+        T * data_;
+        uint32_t size_;
+        uint32_t capacity_;
+        union {
+            T inline_[N]; // constructed element by element
+        };
+
+        [[nodiscard]] bool is_inline () const { return data_ == inline_; }
+
+        // Hands over other's heap buffer if this allocator can free it, otherwise moves the elements,
+        // allocating only when they don't fit inline. Expects this vector to be empty and inline.
+        void take (SmallVector && other) {
+            if (!other.is_inline() && alloc_ == other.alloc_) {
+                data_ = std::exchange(other.data_, other.inline_);
+                size_ = std::exchange(other.size_, 0);
+                capacity_ = std::exchange(other.capacity_, static_cast<uint32_t>(N));
+                return;
+            }
+            if (other.size_ > N) {
+                data_ = Traits::allocate(alloc_, other.size_);
+                capacity_ = other.size_;
+            }
+            std::uninitialized_move(other.begin(), other.end(), data_);
+            size_ = other.size_;
+            other.clear();
+        }
+
+        void release () noexcept {
+            clear();
+            if (!is_inline()) Traits::deallocate(alloc_, data_, capacity_);
+            data_ = inline_;
+            capacity_ = N;
+        }
+
+        void grow () {
+            reserve(std::min<size_t>(size_t(capacity_) * 2, UINT32_MAX));
+        }
+
+    public:
+        explicit SmallVector (const Allocator & alloc = Allocator()) noexcept
+            : alloc_(alloc), data_(inline_), size_(0), capacity_(N) {};
+        SmallVector (SmallVector && other) noexcept : SmallVector(other.alloc_) {
+            take(std::move(other));
+        };
+        SmallVector& operator= (SmallVector && other)
+            noexcept(Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) {
+            if (this != &other) {
+                release();
+                if constexpr (Traits::propagate_on_container_move_assignment::value) alloc_ = other.alloc_;
+                take(std::move(other));
+            }
+            return *this;
+        }
+        SmallVector (const SmallVector&)            = delete;
+        SmallVector& operator= (const SmallVector&) = delete;
+
+        ~SmallVector () {
+            release();
+        }
+
+        template<class ...Params>
+        T & emplace_back (Params &&... params) {
+            if (size_ == capacity_) {
+                T element(std::forward<Params>(params)...); // params may refer into the buffer
+                grow();
+                return *::new (static_cast<void*>(data_ + size_++)) T(std::move(element));
+            }
+            return *::new (static_cast<void*>(data_ + size_++)) T(std::forward<Params>(params)...);
+        }
+        void push_back (T && value) { emplace_back(std::move(value)); }
+        void push_back (const T & value) { emplace_back(value); }
+
+        void pop_back () {
+            std::destroy_at(data_ + --size_);
+        }
+
+        /// Makes room for at least capacity elements, the following push_backs up to it neither allocate nor throw.
+        void reserve (size_t capacity) {
+            if (capacity <= capacity_) return;
+            T * data = Traits::allocate(alloc_, capacity);
+            std::uninitialized_move(begin(), end(), data);
+            std::destroy(begin(), end());
+            if (!is_inline()) Traits::deallocate(alloc_, data_, capacity_);
+            data_ = data;
+            capacity_ = static_cast<uint32_t>(capacity);
+        }
+
+        void clear () noexcept {
+            std::destroy(begin(), end());
+            size_ = 0;
+        }
+
+        [[nodiscard]] T & operator[] (size_t i) { return data_[i]; }
+        [[nodiscard]] const T & operator[] (size_t i) const { return data_[i]; }
+        [[nodiscard]] T & back () { return data_[size_ - 1]; }
+        [[nodiscard]] const T & back () const { return data_[size_ - 1]; }
+        [[nodiscard]] T * begin () { return data_; }
+        [[nodiscard]] T * end () { return data_ + size_; }
+        [[nodiscard]] const T * begin () const { return data_; }
+        [[nodiscard]] const T * end () const { return data_ + size_; }
+        [[nodiscard]] size_t size () const { return size_; }
+        [[nodiscard]] size_t capacity () const { return capacity_; }
+        [[nodiscard]] bool empty () const { return !size_; }
+        [[nodiscard]] Allocator get_allocator () const { return alloc_; }
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include "SimpleSignal.hpp"
+
+namespace Simple {
+    template<NothrowVoidInvokable, auto...> class StaticSignal;
+
+    /// Signal whose slots are fixed at compile time: function pointers or constexpr callables
+    /// (e.g. captureless lambdas) given as template arguments. emit has the calling convention of
+    /// Signal::emit and expands into direct calls the compiler can inline, there is no storage at all.
+    template<class R, class... Args, auto... Slots>
+    class StaticSignal<R (Args...), Slots...> {
+        static_assert((std::is_invocable_r_v<R, decltype(Slots), Args...> && ...),
+                      "Every slot must be invocable with the signal arguments");
+    public:
+        /// Emit a signal, i.e. invoke all its callbacks in the order they are listed.
+        void emit (Args&& ...args) const {
+            (std::invoke(Slots, std::forward<Args>(args)...), ...);
+        }
+
+        [[nodiscard]] static constexpr std::size_t size () {
+            return sizeof...(Slots);
+        }
+    };
+}
@@ -0,0 +1,238 @@
+#include "benchmark/benchmark.h"
+#include "SessionManager/SessionManager.hpp"
+#include "SessionManager/ConcurrentSessionManager.hpp"
+#include <mutex>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Fill-ratio benchmarks run against a manager of bench_capacity sessions pre-filled to state.range(0) percent
+constexpr const size_t bench_capacity = 1 << 16;
+constexpr const size_t bench_batch = 1024; // operations between two untimed refills
+
+struct BenchSession { size_t hits = 0; };
+
+template<size_t Size>
+struct BenchPayload {
+    std::array<std::byte, Size> data{};
+    size_t hits = 0;
+};
+
+template<typename Session>
+using BenchManager = Simple::SessionManager<Session, std::allocator<Session>, Simple::FastHandleGenerator>;
+
+// Fills the manager to the requested percentage of its capacity, returns the live handles in random order
+template<typename Manager>
+static std::vector<size_t> fill_to(Manager & sess_mgr, int64_t percent, std::minstd_rand & rng) {
+    std::vector<size_t> handles(bench_capacity * percent / 100);
+    // Interleave creates and deletes first, so free slots are scattered like in a long running process
+    for (size_t i = 0; i < handles.size(); ++i) handles[i] = sess_mgr.new_session();
+    for (size_t i = 0; i < handles.size() / 2; ++i) {
+        size_t victim = rng() % handles.size();
+        sess_mgr.delete_session(handles[victim]);
+        handles[victim] = sess_mgr.new_session();
+    }
+    std::shuffle(handles.begin(), handles.end(), rng);
+    return handles;
+}
+
+static void FillRatios(benchmark::internal::Benchmark * bench) {
+    for (int64_t percent : {10, 50, 90, 99}) bench->Arg(percent);
+}
+
+template<typename Session>
+static void BM_SessionCreateAtFill(benchmark::State& state) {
+    BenchManager<Session> sess_mgr(bench_capacity + bench_batch);
+    std::minstd_rand rng;
+    auto handles = fill_to(sess_mgr, state.range(0), rng);
+    std::vector<size_t> created;
+    created.reserve(bench_batch);
+    for (auto _ : state) {
+        created.push_back(sess_mgr.new_session());
+        if (created.size() == bench_batch) {
+            state.PauseTiming();
+            sess_mgr.delete_sessions(created);
+            created.clear();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SessionCreateAtFill, BenchSession)->Apply(FillRatios);
+
+template<typename Session>
+static void BM_SessionLookupAtFill(benchmark::State& state) {
+    BenchManager<Session> sess_mgr(bench_capacity);
+    std::minstd_rand rng;
+    auto handles = fill_to(sess_mgr, state.range(0), rng);
+    size_t next = 0;
+    for (auto _ : state) {
+        sess_mgr.get_session(handles[next]).hits++;
+        if (++next == handles.size()) next = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SessionLookupAtFill, BenchSession)->Apply(FillRatios);
+
+template<typename Session>
+static void BM_SessionDeleteAtFill(benchmark::State& state) {
+    BenchManager<Session> sess_mgr(bench_capacity);
+    std::minstd_rand rng;
+    auto handles = fill_to(sess_mgr, state.range(0), rng);
+    size_t next = 0;
+    for (auto _ : state) {
+        sess_mgr.delete_session(handles[next]);
+        if (++next == std::min(bench_batch, handles.size())) {
+            state.PauseTiming();
+            for (size_t i = 0; i < next; ++i) handles[i] = sess_mgr.new_session();
+            next = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SessionDeleteAtFill, BenchSession)->Apply(FillRatios);
+
+// Steady state churn: every iteration deletes a random live session and creates a replacement
+template<typename Session>
+static void BM_SessionChurnAtFill(benchmark::State& state) {
+    BenchManager<Session> sess_mgr(bench_capacity);
+    std::minstd_rand rng;
+    auto handles = fill_to(sess_mgr, state.range(0), rng);
+    for (auto _ : state) {
+        size_t victim = rng() % handles.size();
+        sess_mgr.delete_session(handles[victim]);
+        handles[victim] = sess_mgr.new_session();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SessionChurnAtFill, BenchSession)->Apply(FillRatios);
+BENCHMARK_TEMPLATE(BM_SessionChurnAtFill, BenchPayload<16>)->Arg(90);
+BENCHMARK_TEMPLATE(BM_SessionChurnAtFill, BenchPayload<64>)->Arg(90);
+BENCHMARK_TEMPLATE(BM_SessionChurnAtFill, BenchPayload<256>)->Arg(90);
+BENCHMARK_TEMPLATE(BM_SessionChurnAtFill, BenchPayload<1024>)->Arg(90);
+
+template<typename Session>
+static void BM_SessionLookupByPayload(benchmark::State& state) {
+    BenchManager<Session> sess_mgr(bench_capacity);
+    std::minstd_rand rng;
+    auto handles = fill_to(sess_mgr, 90, rng);
+    size_t next = 0;
+    for (auto _ : state) {
+        sess_mgr.get_session(handles[next]).hits++;
+        if (++next == handles.size()) next = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * sizeof(Session));
+}
+BENCHMARK_TEMPLATE(BM_SessionLookupByPayload, BenchPayload<16>);
+BENCHMARK_TEMPLATE(BM_SessionLookupByPayload, BenchPayload<64>);
+BENCHMARK_TEMPLATE(BM_SessionLookupByPayload, BenchPayload<256>);
+BENCHMARK_TEMPLATE(BM_SessionLookupByPayload, BenchPayload<1024>);
+
+static void BM_LockedSessionChurn(benchmark::State& state) {
+    static std::mutex mtx;
+    static Simple::SessionManager<BenchSession> sess_mgr(1 << 20);
+    for (auto _ : state) {
+        size_t handle;
+        { std::lock_guard lock(mtx); handle = sess_mgr.new_session(); }
+        { std::lock_guard lock(mtx); sess_mgr.get_session(handle).hits++; }
+        { std::lock_guard lock(mtx); sess_mgr.delete_session(handle); }
+    }
+}
+BENCHMARK(BM_LockedSessionChurn)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_ShardedSessionChurn(benchmark::State& state) {
+    static Simple::ConcurrentSessionManager<BenchSession, 64> sess_mgr(1 << 20);
+    for (auto _ : state) {
+        size_t handle = sess_mgr.new_session();
+        sess_mgr.visit_session(handle, [] (BenchSession & sess) { sess.hits++; });
+        sess_mgr.delete_session(handle);
+    }
+}
+BENCHMARK(BM_ShardedSessionChurn)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_ShardedSessionCount(benchmark::State& state) {
+    static Simple::ConcurrentSessionManager<BenchSession, 64> sess_mgr(1 << 20);
+    for (auto _ : state) benchmark::DoNotOptimize(sess_mgr.count());
+}
+BENCHMARK(BM_ShardedSessionCount)->ThreadRange(1, 64)->UseRealTime();
+
+// Multi-threaded lookups of a shared population filled to 90%, the first thread sets it up for everyone
+static std::vector<size_t> shared_handles;
+
+static void BM_LockedSessionLookup(benchmark::State& state) {
+    static std::mutex mtx;
+    static std::unique_ptr<BenchManager<BenchSession>> sess_mgr;
+    if (state.thread_index() == 0) {
+        std::minstd_rand rng;
+        sess_mgr = std::make_unique<BenchManager<BenchSession>>(bench_capacity);
+        shared_handles = fill_to(*sess_mgr, 90, rng);
+    }
+    size_t next = state.thread_index() * 7919;
+    for (auto _ : state) {
+        std::lock_guard lock(mtx);
+        sess_mgr->get_session(shared_handles[next++ % shared_handles.size()]).hits++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockedSessionLookup)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_ShardedSessionVisit(benchmark::State& state) {
+    static std::unique_ptr<Simple::ConcurrentSessionManager<BenchSession, 64>> sess_mgr;
+    if (state.thread_index() == 0) {
+        std::minstd_rand rng;
+        sess_mgr = std::make_unique<Simple::ConcurrentSessionManager<BenchSession, 64>>(bench_capacity);
+        shared_handles = fill_to(*sess_mgr, 90, rng);
+    }
+    size_t next = state.thread_index() * 7919;
+    for (auto _ : state)
+        sess_mgr->visit_session(shared_handles[next++ % shared_handles.size()], [] (BenchSession & sess) { sess.hits++; });
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShardedSessionVisit)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_ShardedSessionLease(benchmark::State& state) {
+    static std::unique_ptr<Simple::ConcurrentSessionManager<BenchSession, 64>> sess_mgr;
+    if (state.thread_index() == 0) {
+        std::minstd_rand rng;
+        sess_mgr = std::make_unique<Simple::ConcurrentSessionManager<BenchSession, 64>>(bench_capacity);
+        shared_handles = fill_to(*sess_mgr, 90, rng);
+    }
+    size_t next = state.thread_index() * 7919;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sess_mgr->acquire_session(shared_handles[next++ % shared_handles.size()])->hits);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShardedSessionLease)->ThreadRange(1, 16)->UseRealTime();
+
+template<Simple::HandleGenerator HandleGen>
+static void BM_HandleGeneration(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(HandleGen::next());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_HandleGeneration, Simple::Mt19937HandleGenerator);
+BENCHMARK_TEMPLATE(BM_HandleGeneration, Simple::FastHandleGenerator);
+BENCHMARK_TEMPLATE(BM_HandleGeneration, Simple::SecureHandleGenerator);
+
+template<Simple::HandleGenerator HandleGen>
+static void BM_SessionChurnByGenerator(benchmark::State& state) {
+    Simple::SessionManager<BenchSession, std::allocator<BenchSession>, HandleGen> sess_mgr;
+    for (auto _ : state) sess_mgr.delete_session(sess_mgr.new_session());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SessionChurnByGenerator, Simple::Mt19937HandleGenerator);
+BENCHMARK_TEMPLATE(BM_SessionChurnByGenerator, Simple::FastHandleGenerator);
+BENCHMARK_TEMPLATE(BM_SessionChurnByGenerator, Simple::SecureHandleGenerator);
+
+template<typename Stats>
+static void BM_SessionChurnByStats(benchmark::State& state) {
+    Simple::SessionManager<BenchSession, std::allocator<BenchSession>, Simple::FastHandleGenerator, Stats> sess_mgr;
+    for (auto _ : state) sess_mgr.delete_session(sess_mgr.new_session());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SessionChurnByStats, Simple::NullSessionStats);
+BENCHMARK_TEMPLATE(BM_SessionChurnByStats, Simple::SessionStats);
@@ -0,0 +1,185 @@
+#include "benchmark/benchmark.h"
+#include "SimpleSignal/SimpleSignal.hpp"
+#include "SimpleSignal/ConcurrentSignal.hpp"
+#include <boost/signals2.hpp>
+#include <mutex>
+#include <array>
+#include <random>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#define IGNORE_RETURN(expr) static_cast<void>(expr)
+
+// Every suite runs against Simple::Signal and, as a reference point, boost::signals2::signal
+using SimpleSignal = Simple::Signal<void(int)>;
+using BoostSignal = boost::signals2::signal<void(int)>;
+
+[[gnu::noinline]] void sink_cb(int value) { benchmark::DoNotOptimize(value); }
+
+static void SlotCounts(benchmark::internal::Benchmark * bench) {
+    for (int64_t slots : {1, 10, 100, 1000, 10000}) bench->Arg(slots);
+}
+
+static void BM_SignalEmitBySlots(benchmark::State& state) {
+    SimpleSignal signal(state.range(0));
+    for (int64_t i = 0; i < state.range(0); ++i) IGNORE_RETURN(signal.connect<sink_cb>());
+    for (auto _ : state) signal.emit(1);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SignalEmitBySlots)->Apply(SlotCounts);
+
+static void BM_Signals2EmitBySlots(benchmark::State& state) {
+    BoostSignal signal;
+    for (int64_t i = 0; i < state.range(0); ++i) signal.connect(sink_cb);
+    for (auto _ : state) signal(1);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Signals2EmitBySlots)->Apply(SlotCounts);
+
+// Connects twice the slots, then disconnects a random half, leaving a scattered free list behind
+static void BM_SignalEmitFragmented(benchmark::State& state) {
+    SimpleSignal signal(state.range(0) * 2);
+    std::vector<SimpleSignal::SlotHandle> handles;
+    for (int64_t i = 0; i < state.range(0) * 2; ++i) handles.push_back(signal.connect<sink_cb>());
+    std::shuffle(handles.begin(), handles.end(), std::minstd_rand());
+    for (int64_t i = 0; i < state.range(0); ++i) signal.disconnect(handles[i]);
+    for (auto _ : state) signal.emit(1);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SignalEmitFragmented)->Apply(SlotCounts);
+
+static void BM_Signals2EmitFragmented(benchmark::State& state) {
+    BoostSignal signal;
+    std::vector<boost::signals2::connection> connections;
+    for (int64_t i = 0; i < state.range(0) * 2; ++i) connections.push_back(signal.connect(sink_cb));
+    std::shuffle(connections.begin(), connections.end(), std::minstd_rand());
+    for (int64_t i = 0; i < state.range(0); ++i) connections[i].disconnect();
+    for (auto _ : state) signal(1);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Signals2EmitFragmented)->Apply(SlotCounts);
+
+// Steady state churn: every iteration disconnects a random slot and connects a replacement
+static void BM_SignalConnectChurn(benchmark::State& state) {
+    SimpleSignal signal(state.range(0));
+    std::vector<SimpleSignal::SlotHandle> handles;
+    for (int64_t i = 0; i < state.range(0); ++i) handles.push_back(signal.connect<sink_cb>());
+    std::minstd_rand rng;
+    for (auto _ : state) {
+        auto & victim = handles[rng() % handles.size()];
+        signal.disconnect(victim);
+        victim = signal.connect<sink_cb>();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SignalConnectChurn)->Apply(SlotCounts);
+
+static void BM_Signals2ConnectChurn(benchmark::State& state) {
+    BoostSignal signal;
+    std::vector<boost::signals2::connection> connections;
+    for (int64_t i = 0; i < state.range(0); ++i) connections.push_back(signal.connect(sink_cb));
+    std::minstd_rand rng;
+    for (auto _ : state) {
+        auto & victim = connections[rng() % connections.size()];
+        victim.disconnect();
+        victim = signal.connect(sink_cb);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Signals2ConnectChurn)->Apply(SlotCounts);
+
+// Emit to 16 lambdas capturing Bytes bytes each, beyond the inline capacity they live on the heap
+constexpr const size_t capture_slots = 16;
+
+template<size_t Bytes>
+struct Capture {
+    std::array<char, Bytes> state{};
+    void operator()(int value) const { benchmark::DoNotOptimize(value + state[Bytes - 1]); }
+};
+
+template<size_t Bytes>
+static void BM_SignalEmitByCapture(benchmark::State& state) {
+    SimpleSignal signal;
+    for (size_t i = 0; i < capture_slots; ++i) IGNORE_RETURN(signal.connect(Capture<Bytes>()));
+    for (auto _ : state) signal.emit(1);
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK_TEMPLATE(BM_SignalEmitByCapture, 8);
+BENCHMARK_TEMPLATE(BM_SignalEmitByCapture, 24);
+BENCHMARK_TEMPLATE(BM_SignalEmitByCapture, 64);
+BENCHMARK_TEMPLATE(BM_SignalEmitByCapture, 256);
+
+template<size_t Bytes>
+static void BM_Signals2EmitByCapture(benchmark::State& state) {
+    BoostSignal signal;
+    for (size_t i = 0; i < capture_slots; ++i) signal.connect(Capture<Bytes>());
+    for (auto _ : state) signal(1);
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK_TEMPLATE(BM_Signals2EmitByCapture, 8);
+BENCHMARK_TEMPLATE(BM_Signals2EmitByCapture, 24);
+BENCHMARK_TEMPLATE(BM_Signals2EmitByCapture, 64);
+BENCHMARK_TEMPLATE(BM_Signals2EmitByCapture, 256);
+
+// Emit to 16 member function slots of distinct objects
+struct Receiver {
+    int total = 0;
+    [[gnu::noinline]] void on_value(int value) { total += value; }
+};
+
+static void BM_SignalEmitMember(benchmark::State& state) {
+    std::vector<Receiver> receivers(capture_slots);
+    SimpleSignal signal;
+    for (auto & receiver : receivers) IGNORE_RETURN(signal.connect_slot(receiver, &Receiver::on_value));
+    for (auto _ : state) signal.emit(1);
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK(BM_SignalEmitMember);
+
+static void BM_SignalEmitMemberBound(benchmark::State& state) {
+    std::vector<Receiver> receivers(capture_slots);
+    SimpleSignal signal;
+    for (auto & receiver : receivers) IGNORE_RETURN(signal.connect_slot<&Receiver::on_value>(receiver));
+    for (auto _ : state) signal.emit(1);
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK(BM_SignalEmitMemberBound);
+
+static void BM_Signals2EmitMember(benchmark::State& state) {
+    std::vector<Receiver> receivers(capture_slots);
+    BoostSignal signal;
+    for (auto & receiver : receivers) signal.connect(BoostSignal::slot_type(&Receiver::on_value, &receiver, boost::placeholders::_1));
+    for (auto _ : state) signal(1);
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK(BM_Signals2EmitMember);
+
+// Several threads publishing through one signal of 16 slots, the first thread connects them for everyone
+static void BM_LockedSignalPublish(benchmark::State& state) {
+    static std::mutex mtx;
+    static SimpleSignal signal;
+    if (state.thread_index() == 0 && !signal.size())
+        for (size_t i = 0; i < capture_slots; ++i) IGNORE_RETURN(signal.connect<sink_cb>());
+    for (auto _ : state) { std::lock_guard lock(mtx); signal.emit(1); }
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK(BM_LockedSignalPublish)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_ConcurrentSignalPublish(benchmark::State& state) {
+    static Simple::ConcurrentSignal<void(int)> signal;
+    if (state.thread_index() == 0 && !signal.size())
+        for (size_t i = 0; i < capture_slots; ++i) IGNORE_RETURN(signal.connect<sink_cb>());
+    for (auto _ : state) signal.emit(1);
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK(BM_ConcurrentSignalPublish)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_Signals2Publish(benchmark::State& state) {
+    static BoostSignal signal;
+    if (state.thread_index() == 0 && signal.empty())
+        for (size_t i = 0; i < capture_slots; ++i) signal.connect(sink_cb);
+    for (auto _ : state) signal(1);
+    state.SetItemsProcessed(state.iterations() * capture_slots);
+}
+BENCHMARK(BM_Signals2Publish)->ThreadRange(1, 16)->UseRealTime();
@@ -1,10 +1,37 @@
 #include "benchmark/benchmark.h"
 #include "SimpleSignal/SimpleSignal.hpp"
-#include "HPHashMap/HazardPointer.hpp"
+#include "SimpleSignal/ConcurrentSignal.hpp"
+#include "SimpleSignal/AsyncSignal.hpp"
+#include "SimpleSignal/StaticSignal.hpp"
+#include "HPHashMap/WRRMMap.hpp"
+#include "HPHashMap/HPHashMap.hpp"
 #include <mutex>
 #include <cmath>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <random>
+#include <array>
+#include <span>
+#include <tuple>
 #define IGNORE_RETURN(expr) static_cast<void>(expr)
 
+// Passes allocations on to the default heap and counts the bytes, lets benchmarks report per-object footprint
+class CountingResource : public std::pmr::memory_resource {
+    void * do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void * ptr, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+        return this == &other;
+    }
+public:
+    size_t allocated = 0;
+};
+
 double global = 0;
 [[gnu::noinline]] void cdummy_cb() { global += sqrt(15) + pow(10, -3); } // Some "complex" callback
 
@@ -17,6 +44,224 @@ static void BM_SignalEmit3(benchmark::State& state) {
 }
 BENCHMARK(BM_SignalEmit3);
 
+static void BM_SignalEmit3Bound(benchmark::State& state) {
+    Simple::Signal<decltype(cdummy_cb)> signal(3);
+    IGNORE_RETURN(signal.connect<cdummy_cb>()); // Connect callback 1
+    IGNORE_RETURN(signal.connect<cdummy_cb>()); // Connect callback 2
+    IGNORE_RETURN(signal.connect<cdummy_cb>()); // Connect callback 3
+    for (auto _ : state) signal.emit();
+}
+BENCHMARK(BM_SignalEmit3Bound);
+
+static void BM_ProfiledSignalEmit3(benchmark::State& state) {
+    Simple::Signal<decltype(cdummy_cb), Simple::default_inline_slots, Simple::SignalProfiler> signal(3);
+    IGNORE_RETURN(signal.connect<cdummy_cb>()); // Connect callback 1
+    IGNORE_RETURN(signal.connect<cdummy_cb>()); // Connect callback 2
+    IGNORE_RETURN(signal.connect<cdummy_cb>()); // Connect callback 3
+    for (auto _ : state) signal.emit();
+}
+BENCHMARK(BM_ProfiledSignalEmit3);
+
+static void BM_StaticSignalEmit3(benchmark::State& state) {
+    Simple::StaticSignal<decltype(cdummy_cb), cdummy_cb, cdummy_cb, cdummy_cb> signal;
+    for (auto _ : state) signal.emit();
+}
+BENCHMARK(BM_StaticSignalEmit3);
+
+// A stream of state.range(0) events delivered to 8 slots, each updating a histogram of its own
+struct Histogram {
+    std::array<uint32_t, 1024> buckets{};
+    void add(uint32_t value) { buckets[value % buckets.size()]++; }
+};
+
+static std::vector<std::tuple<uint32_t>> make_stream(size_t size) {
+    std::vector<std::tuple<uint32_t>> events(size);
+    uint32_t value = 1;
+    for (auto & [event] : events) event = value = value * 1664525 + 1013904223;
+    return events;
+}
+
+static void BM_SignalEmitStream(benchmark::State& state) {
+    std::vector<Histogram> histograms(8);
+    Simple::Signal<void(uint32_t)> signal;
+    for (auto & histogram : histograms) IGNORE_RETURN(signal.connect([&histogram] (uint32_t value) { histogram.add(value); }));
+    const auto events = make_stream(state.range(0));
+    for (auto _ : state)
+        for (const auto & [value] : events) signal.emit(uint32_t(value));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SignalEmitStream)->Arg(64)->Arg(1024)->Arg(16384);
+
+static void BM_SignalEmitBatch(benchmark::State& state) {
+    std::vector<Histogram> histograms(8);
+    Simple::Signal<void(uint32_t)> signal;
+    for (auto & histogram : histograms) IGNORE_RETURN(signal.connect([&histogram] (uint32_t value) { histogram.add(value); }));
+    const auto events = make_stream(state.range(0));
+    for (auto _ : state) signal.emit_batch(events);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SignalEmitBatch)->Arg(64)->Arg(1024)->Arg(16384);
+
+static void BM_SignalEmitBatchNative(benchmark::State& state) {
+    std::vector<Histogram> histograms(8);
+    Simple::Signal<void(uint32_t)> signal;
+    for (auto & histogram : histograms)
+        IGNORE_RETURN(signal.connect_batch([&histogram] (std::span<const std::tuple<uint32_t>> events) {
+            for (const auto & [value] : events) histogram.add(value);
+        }));
+    const auto events = make_stream(state.range(0));
+    for (auto _ : state) signal.emit_batch(events);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SignalEmitBatchNative)->Arg(64)->Arg(1024)->Arg(16384);
+
+// Fan-out over state.range(0) slots of about a microsecond each, serial emit against the shared pool.
+// Where the two curves cross is a good default_parallel_threshold for the machine.
+[[gnu::noinline]] void busy_cb() {
+    double value = global;
+    for (int i = 0; i < 100; ++i) value = sqrt(value + i);
+    global = value;
+}
+
+static void FanOuts(benchmark::internal::Benchmark * bench) {
+    for (int64_t slots : {1, 2, 4, 8, 16, 32, 64, 128, 256, 1024}) bench->Arg(slots);
+}
+
+static void BM_SignalEmitFanOut(benchmark::State& state) {
+    Simple::Signal<void()> signal(state.range(0));
+    for (int64_t i = 0; i < state.range(0); ++i) IGNORE_RETURN(signal.connect<busy_cb>());
+    for (auto _ : state) signal.emit();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SignalEmitFanOut)->Apply(FanOuts)->UseRealTime();
+
+static void BM_SignalEmitParallelFanOut(benchmark::State& state) {
+    Simple::Signal<void()> signal(state.range(0));
+    for (int64_t i = 0; i < state.range(0); ++i) IGNORE_RETURN(signal.connect<busy_cb>());
+    auto & pool = Simple::WorkStealingPool::shared();
+    for (auto _ : state) signal.emit_parallel(pool, 0);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["workers"] = static_cast<double>(pool.workers());
+}
+BENCHMARK(BM_SignalEmitParallelFanOut)->Apply(FanOuts)->UseRealTime();
+
+static void BM_LockedSignalEmit3(benchmark::State& state) {
+    static std::mutex mtx;
+    static Simple::Signal<decltype(cdummy_cb)> signal(3);
+    if (state.thread_index() == 0 && !signal.size())
+        for (int i = 0; i < 3; ++i) IGNORE_RETURN(signal.connect<cdummy_cb>());
+    for (auto _ : state) { std::lock_guard lock(mtx); signal.emit(); }
+}
+BENCHMARK(BM_LockedSignalEmit3)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_ConcurrentSignalEmit3(benchmark::State& state) {
+    static Simple::ConcurrentSignal<decltype(cdummy_cb)> signal(3);
+    if (state.thread_index() == 0 && !signal.size())
+        for (int i = 0; i < 3; ++i) IGNORE_RETURN(signal.connect<cdummy_cb>());
+    for (auto _ : state) signal.emit();
+}
+BENCHMARK(BM_ConcurrentSignalEmit3)->ThreadRange(1, 16)->UseRealTime();
+
+// The first thread keeps connecting and disconnecting a fourth slot while the others emit
+static void BM_LockedSignalEmitWithChurn(benchmark::State& state) {
+    static std::mutex mtx;
+    static Simple::Signal<decltype(cdummy_cb)> signal(4);
+    if (state.thread_index() == 0 && !signal.size())
+        for (int i = 0; i < 3; ++i) IGNORE_RETURN(signal.connect<cdummy_cb>());
+    for (auto _ : state) {
+        std::lock_guard lock(mtx);
+        if (state.thread_index() == 0) signal.disconnect(signal.connect<cdummy_cb>());
+        else signal.emit();
+    }
+}
+BENCHMARK(BM_LockedSignalEmitWithChurn)->ThreadRange(2, 16)->UseRealTime();
+
+static void BM_ConcurrentSignalEmitWithChurn(benchmark::State& state) {
+    static Simple::ConcurrentSignal<decltype(cdummy_cb)> signal(4);
+    if (state.thread_index() == 0 && !signal.size())
+        for (int i = 0; i < 3; ++i) IGNORE_RETURN(signal.connect<cdummy_cb>());
+    for (auto _ : state) {
+        if (state.thread_index() == 0) signal.disconnect(signal.connect<cdummy_cb>());
+        else signal.emit();
+    }
+}
+BENCHMARK(BM_ConcurrentSignalEmitWithChurn)->ThreadRange(2, 16)->UseRealTime();
+
+// Publisher side cost with a slot that takes roughly 50 direct callback calls
+[[gnu::noinline]] void slow_cb() { for (int i = 0; i < 50; ++i) cdummy_cb(); }
+
+static void BM_SignalEmitSlowSlot(benchmark::State& state) {
+    Simple::Signal<decltype(slow_cb)> signal(1);
+    IGNORE_RETURN(signal.connect<slow_cb>());
+    for (auto _ : state) signal.emit();
+}
+BENCHMARK(BM_SignalEmitSlowSlot);
+
+static void BM_AsyncSignalEmitSlowSlot(benchmark::State& state) {
+    Simple::AsyncSignal<decltype(slow_cb)> signal(1 << 16, 1, Simple::AsyncOverflow::Drop);
+    IGNORE_RETURN(signal.connect<slow_cb>());
+    for (auto _ : state) signal.emit_async();
+    signal.flush();
+    state.counters["dropped"] = static_cast<double>(signal.dropped());
+}
+BENCHMARK(BM_AsyncSignalEmitSlowSlot);
+
+// End to end throughput, the publisher blocks whenever the workers fall behind
+static void BM_AsyncSignalThroughput(benchmark::State& state) {
+    Simple::AsyncSignal<decltype(cdummy_cb)> signal(1024, state.range(0));
+    IGNORE_RETURN(signal.connect<cdummy_cb>());
+    for (auto _ : state) signal.emit_async();
+    signal.flush();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AsyncSignalThroughput)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// Footprint of a signal with state.range(0) connected slots, as embedded once per entity. The signal
+// allocates through a counting resource, its heap storage grows exactly as with the default allocator.
+static void BM_SignalFootprint(benchmark::State& state) {
+    using CountedSignal = Simple::Signal<decltype(cdummy_cb), Simple::default_inline_slots, Simple::NullSignalProfiler,
+                                         std::pmr::polymorphic_allocator<std::byte>>;
+    CountingResource resource;
+    for (auto _ : state) {
+        const size_t before = resource.allocated;
+        CountedSignal signal(Simple::default_max_callbacks, {}, &resource);
+        for (int64_t i = 0; i < state.range(0); ++i) IGNORE_RETURN(signal.connect<cdummy_cb>());
+        benchmark::DoNotOptimize(&signal);
+        state.counters["bytes_per_signal"] =
+            static_cast<double>(sizeof(Simple::Signal<decltype(cdummy_cb)>) + resource.allocated - before);
+    }
+}
+BENCHMARK(BM_SignalFootprint)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(16)->Arg(256);
+
+static void BM_SignalConstruct(benchmark::State& state) {
+    for (auto _ : state) {
+        Simple::Signal<decltype(cdummy_cb)> signal;
+        benchmark::DoNotOptimize(&signal);
+    }
+}
+BENCHMARK(BM_SignalConstruct);
+
+static void BM_SignalConstructConnect2(benchmark::State& state) {
+    for (auto _ : state) {
+        Simple::Signal<decltype(cdummy_cb)> signal;
+        IGNORE_RETURN(signal.connect<cdummy_cb>());
+        IGNORE_RETURN(signal.connect<cdummy_cb>());
+        benchmark::DoNotOptimize(&signal);
+    }
+}
+BENCHMARK(BM_SignalConstructConnect2);
+
+// A million entities with one small signal each
+static void BM_SignalPerEntity(benchmark::State& state) {
+    for (auto _ : state) {
+        std::vector<Simple::Signal<decltype(cdummy_cb)>> entities(1 << 20);
+        for (auto & signal : entities) IGNORE_RETURN(signal.connect<cdummy_cb>());
+        benchmark::DoNotOptimize(entities.data());
+    }
+    state.counters["bytes_per_entity"] = static_cast<double>(sizeof(Simple::Signal<decltype(cdummy_cb)>));
+}
+BENCHMARK(BM_SignalPerEntity)->Unit(benchmark::kMillisecond);
+
 static void BM_DirectCbCall3(benchmark::State& state) {
     for (auto _ : state) { cdummy_cb(); cdummy_cb(); cdummy_cb(); }
 }
@@ -36,18 +281,116 @@ static void BM_MapLookup(benchmark::State& state) {
 BENCHMARK(BM_MapLookup);
 
 static void BM_HPMapUpdate(benchmark::State& state) {
-    WRRMMap mymap;
+    WRRMMap<> mymap;
     for (auto _ : state) mymap.Update(10, 15);
 }
 BENCHMARK(BM_HPMapUpdate);
 
 static void BM_HPMapLookup(benchmark::State& state) {
-    WRRMMap mymap;
+    WRRMMap<> mymap;
     mymap.Update(10, 15);
     for (auto _ : state) mymap.Lookup(10);
 }
 BENCHMARK(BM_HPMapLookup);
 
+static void BM_EpochMapUpdate(benchmark::State& state) {
+    WRRMMap<EpochDomain<>> mymap;
+    for (auto _ : state) mymap.Update(10, 15);
+}
+BENCHMARK(BM_EpochMapUpdate);
+
+static void BM_EpochMapLookup(benchmark::State& state) {
+    WRRMMap<EpochDomain<>> mymap;
+    mymap.Update(10, 15);
+    for (auto _ : state) mymap.Lookup(10);
+}
+BENCHMARK(BM_EpochMapLookup);
+
+static void BM_HazardGuardProtect(benchmark::State& state) {
+    std::atomic<int*> shared = new int(1);
+    for (auto _ : state) {
+        HazardDomain<>::Guard guard;
+        benchmark::DoNotOptimize(*guard.Protect(shared));
+    }
+    delete shared.load();
+}
+BENCHMARK(BM_HazardGuardProtect);
+
+static void BM_HazardRetire(benchmark::State& state) {
+    for (auto _ : state) HazardDomain<>::Retire(new int(1));
+    HazardDomain<>::Scan();
+}
+BENCHMARK(BM_HazardRetire);
+
+static void BM_EpochGuardProtect(benchmark::State& state) {
+    std::atomic<int*> shared = new int(1);
+    for (auto _ : state) {
+        EpochDomain<>::Guard guard;
+        benchmark::DoNotOptimize(*guard.Protect(shared));
+    }
+    delete shared.load();
+}
+BENCHMARK(BM_EpochGuardProtect);
+
+static void BM_EpochRetire(benchmark::State& state) {
+    for (auto _ : state) EpochDomain<>::Retire(new int(1));
+    EpochDomain<>::Scan();
+}
+BENCHMARK(BM_EpochRetire);
+
+constexpr const int map_keys = 1024;
+
+// Random hits in maps of state.range(0) keys: the flat snapshot against the tree it replaced
+static void MapSizes(benchmark::internal::Benchmark * bench) {
+    for (int64_t keys : {16, 1024, 65536}) bench->Arg(keys);
+}
+
+static void BM_StdMapFindBySize(benchmark::State& state) {
+    std::map<int,int> mymap;
+    for (int k = 0; k < state.range(0); ++k) mymap[k * 2] = k;
+    std::minstd_rand rng;
+    for (auto _ : state) benchmark::DoNotOptimize(mymap.find(static_cast<int>(rng() % state.range(0)) * 2));
+}
+BENCHMARK(BM_StdMapFindBySize)->Apply(MapSizes);
+
+static void BM_WRRMMapFindBySize(benchmark::State& state) {
+    WRRMMap<> mymap;
+    for (int k = 0; k < state.range(0); ++k) mymap.Update(k * 2, k);
+    std::minstd_rand rng;
+    for (auto _ : state) benchmark::DoNotOptimize(mymap.Find(static_cast<int>(rng() % state.range(0)) * 2));
+}
+BENCHMARK(BM_WRRMMapFindBySize)->Apply(MapSizes);
+
+// Writers only, all threads updating random keys of one 1024 key map
+static void BM_WRRMMapContendedUpdate(benchmark::State& state) {
+    static std::unique_ptr<WRRMMap<>> map;
+    if (state.thread_index() == 0) {
+        map = std::make_unique<WRRMMap<>>();
+        for (int k = 0; k < map_keys; ++k) map->Update(k, k);
+    }
+    std::minstd_rand rng(state.thread_index() + 1);
+    for (auto _ : state) {
+        const int k = static_cast<int>(rng() % map_keys);
+        map->Update(k, k + 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WRRMMapContendedUpdate)->ThreadRange(1, 16)->UseRealTime();
+
+// One writer applying state.range(0) random updates per snapshot
+static void BM_WRRMMapUpdateBatch(benchmark::State& state) {
+    WRRMMap<> map;
+    for (int k = 0; k < map_keys; ++k) map.Update(k, k);
+    std::minstd_rand rng;
+    std::vector<std::pair<int, int>> updates(state.range(0));
+    for (auto _ : state) {
+        for (auto & update : updates) update = {static_cast<int>(rng() % map_keys), 1};
+        map.UpdateBatch(updates);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WRRMMapUpdateBatch)->Arg(1)->Arg(16)->Arg(256);
+
 static void BM_LockMapUpdate(benchmark::State& state) {
     std::mutex mtx;
     std::map<int,int> mymap;
@@ -63,4 +406,76 @@ static void BM_LockMapLookup(benchmark::State& state) {
 }
 BENCHMARK(BM_LockMapLookup);
 
+static void BM_HPHashMapUpdate(benchmark::State& state) {
+    HPHashMap<int,int> mymap;
+    for (auto _ : state) mymap.Update(10, 15);
+}
+BENCHMARK(BM_HPHashMapUpdate);
+
+static void BM_HPHashMapLookup(benchmark::State& state) {
+    HPHashMap<int,int> mymap;
+    mymap.Update(10, 15);
+    for (auto _ : state) benchmark::DoNotOptimize(mymap.Lookup(10));
+}
+BENCHMARK(BM_HPHashMapLookup);
+
+// Concurrent maps behind one interface: several threads mixing lookups with state.range(0) percent updates.
+// peak_unreclaimed is the most retired but not yet freed objects a thread saw after its updates.
+
+struct LockedMap {
+    std::mutex mtx;
+    std::map<int,int> map;
+    void update(int k, int v) { std::lock_guard lock(mtx); map[k] = v; }
+    int lookup(int k) { std::lock_guard lock(mtx); return map[k]; }
+    static size_t unreclaimed() { return 0; }
+};
+
+template<typename Reclaimer>
+struct WRRMapAdapter {
+    WRRMMap<Reclaimer> map;
+    void update(int k, int v) { map.Update(k, v); }
+    int lookup(int k) { return map.Lookup(k); }
+    static size_t unreclaimed() { return Reclaimer::Unreclaimed(); }
+};
+
+template<typename Reclaimer>
+struct HPHashMapAdapter {
+    HPHashMap<int,int,std::hash<int>,std::equal_to<int>,Reclaimer> map;
+    void update(int k, int v) { map.Update(k, v); }
+    int lookup(int k) { return map.Lookup(k).value_or(0); }
+    static size_t unreclaimed() { return Reclaimer::Unreclaimed(); }
+};
+
+template<typename Map>
+static void BM_ConcurrentMapMixed(benchmark::State& state) {
+    static std::unique_ptr<Map> map;
+    if (state.thread_index() == 0) {
+        map = std::make_unique<Map>();
+        for (int k = 0; k < map_keys; ++k) map->update(k, k);
+    }
+    std::minstd_rand rng(state.thread_index() + 1);
+    size_t peak = 0;
+    for (auto _ : state) {
+        const int k = static_cast<int>(rng() % map_keys);
+        if (static_cast<int64_t>(rng() % 100) < state.range(0)) {
+            map->update(k, k + 1);
+            peak = std::max(peak, Map::unreclaimed());
+        } else {
+            benchmark::DoNotOptimize(map->lookup(k));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["peak_unreclaimed"] = benchmark::Counter(static_cast<double>(peak), benchmark::Counter::kAvgThreads);
+}
+
+static void UpdateRatios(benchmark::internal::Benchmark * bench) {
+    for (int64_t percent : {0, 10, 50}) bench->Arg(percent);
+    bench->ThreadRange(1, 16)->UseRealTime();
+}
+BENCHMARK_TEMPLATE(BM_ConcurrentMapMixed, LockedMap)->Apply(UpdateRatios);
+BENCHMARK_TEMPLATE(BM_ConcurrentMapMixed, WRRMapAdapter<HazardDomain<>>)->Apply(UpdateRatios);
+BENCHMARK_TEMPLATE(BM_ConcurrentMapMixed, WRRMapAdapter<EpochDomain<>>)->Apply(UpdateRatios);
+BENCHMARK_TEMPLATE(BM_ConcurrentMapMixed, HPHashMapAdapter<HazardDomain<>>)->Apply(UpdateRatios);
+BENCHMARK_TEMPLATE(BM_ConcurrentMapMixed, HPHashMapAdapter<EpochDomain<>>)->Apply(UpdateRatios);
+
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "SimpleSignal.hpp"
-#include "HazardPointer.hpp"
+#include "WRRMMap.hpp"
 #include "SessionManager.hpp"
 
-WRRMMap g_hpmap; // Concurrent map through Hazard Pointers
+WRRMMap<> g_hpmap; // Concurrent map through Hazard Pointers
 
 int main() {
     Simple::SessionManager<int> sess_mgr;
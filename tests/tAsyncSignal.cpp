@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "SimpleSignal/AsyncSignal.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+
+#define IGNORE_RETURN(expr) static_cast<void>(expr)
+
+using namespace Simple;
+
+// Slot that parks the worker inside the first event until the gate opens
+struct Gate {
+    std::atomic_bool entered = false;
+    std::atomic_bool open = false;
+    void pass() {
+        entered = true;
+        while (!open) std::this_thread::yield();
+    }
+    void wait_entered() const {
+        while (!entered) std::this_thread::yield();
+    }
+};
+
+TEST(AsyncSignal, FlushDeliversEventsInOrder) {
+    std::vector<int> received;
+    AsyncSignal<void(int)> signal;
+    IGNORE_RETURN(signal.connect([&received] (int i) { received.push_back(i); }));
+    for (int i = 0; i < 5000; ++i) EXPECT_TRUE (signal.emit_async(int(i)));
+    signal.flush();
+    ASSERT_EQ (received.size(), 5000);
+    for (int i = 0; i < 5000; ++i) EXPECT_EQ (received[i], i);
+}
+
+TEST(AsyncSignal, ArgumentsAreCopied) {
+    std::string received;
+    AsyncSignal<void(const std::string &)> signal;
+    IGNORE_RETURN(signal.connect([&received] (const std::string & s) { received += s; }));
+    {
+        std::string temporary = "copied";
+        signal.emit_async(temporary);
+    }
+    signal.flush();
+    EXPECT_EQ (received, "copied");
+}
+
+TEST(AsyncSignal, DropDiscardsNewEventsWhenFull) {
+    Gate gate;
+    std::vector<int> received;
+    AsyncSignal<void(int)> signal(2, 1, AsyncOverflow::Drop);
+    IGNORE_RETURN(signal.connect([&] (int i) { if (i == 0) gate.pass(); received.push_back(i); }));
+    EXPECT_TRUE (signal.emit_async(0));
+    gate.wait_entered();
+    EXPECT_TRUE (signal.emit_async(1));
+    EXPECT_TRUE (signal.emit_async(2));
+    EXPECT_FALSE (signal.emit_async(3));
+    gate.open = true;
+    signal.flush();
+    EXPECT_EQ (received, std::vector<int>({0, 1, 2}));
+    EXPECT_EQ (signal.dropped(), 1);
+}
+
+TEST(AsyncSignal, OverwriteDiscardsOldestEventsWhenFull) {
+    Gate gate;
+    std::vector<int> received;
+    AsyncSignal<void(int)> signal(2, 1, AsyncOverflow::Overwrite);
+    IGNORE_RETURN(signal.connect([&] (int i) { if (i == 0) gate.pass(); received.push_back(i); }));
+    EXPECT_TRUE (signal.emit_async(0));
+    gate.wait_entered();
+    for (int i = 1; i < 5; ++i) EXPECT_TRUE (signal.emit_async(int(i)));
+    gate.open = true;
+    signal.flush();
+    EXPECT_EQ (received, std::vector<int>({0, 3, 4}));
+    EXPECT_EQ (signal.dropped(), 2);
+}
+
+TEST(AsyncSignal, BlockingProducersLoseNothing) {
+    std::atomic_size_t sum = 0;
+    AsyncSignal<void(size_t)> signal(8, 3, AsyncOverflow::Block, 4);
+    IGNORE_RETURN(signal.connect([&sum] (size_t i) { sum += i; }));
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < 4; ++t)
+        producers.emplace_back([&signal] { for (size_t i = 1; i <= 1000; ++i) signal.emit_async(size_t(i)); });
+    for (auto & producer : producers) producer.join();
+    signal.flush();
+    EXPECT_EQ (sum, 4 * 1000 * 1001 / 2);
+    EXPECT_EQ (signal.dropped(), 0);
+}
+
+TEST(AsyncSignal, BlockingEmitFromSlotDropsInsteadOfWaiting) {
+    std::atomic_size_t received = 0;
+    AsyncSignal<void(int)> signal(2, 1, AsyncOverflow::Block);
+    IGNORE_RETURN(signal.connect([&] (int i) {
+        received++;
+        if (i == 0) for (int j = 1; j < 5; ++j) IGNORE_RETURN(signal.emit_async(int(j)));
+    }));
+    EXPECT_TRUE (signal.emit_async(0));
+    signal.flush();
+    signal.flush(); // the events queued by the slot
+    EXPECT_EQ (received, 3);
+    EXPECT_EQ (signal.dropped(), 2);
+}
+
+TEST(AsyncSignal, DestructorDeliversPendingEvents) {
+    std::atomic_size_t calls = 0;
+    {
+        AsyncSignal<void()> signal(16, 2);
+        IGNORE_RETURN(signal.connect([&calls] { calls++; }));
+        for (int i = 0; i < 100; ++i) signal.emit_async();
+    }
+    EXPECT_EQ (calls, 100);
+}
@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "SessionManager/ConcurrentSessionManager.hpp"
+
+#include <thread>
+#include <vector>
+#include <optional>
+
+class DummyConcurrentSession {
+public:
+    int i = 0;
+}; // Mock the session type
+class CountedSession {
+public:
+    static inline int destroyed = 0;
+    int i = 0;
+    ~CountedSession() { destroyed++; }
+};
+#define IGNORE_RETURN(expr) static_cast<void>(expr)
+
+using namespace Simple;
+using DummyManager = ConcurrentSessionManager<DummyConcurrentSession, 4>;
+
+TEST(ConcurrentSessionManager, InitialCountIs0) {
+    DummyManager sess_mgr;
+    EXPECT_EQ (sess_mgr.count(), 0);
+    EXPECT_TRUE (sess_mgr.empty());
+}
+
+TEST(ConcurrentSessionManager, VisitSessReturnsMutableSess) {
+    DummyManager sess_mgr;
+    auto sess_handle = sess_mgr.new_session();
+    sess_mgr.visit_session(sess_handle, [] (DummyConcurrentSession & sess) { sess.i = 13; });
+    EXPECT_EQ (sess_mgr.visit_session(sess_handle, [] (const DummyConcurrentSession & sess) { return sess.i; }), 13);
+}
+
+TEST(ConcurrentSessionManager, DeleteSessWhenEmptyThrows) {
+    DummyManager sess_mgr;
+    EXPECT_THROW (sess_mgr.delete_session(0), DummyManager::SessionInvalid);
+}
+
+TEST(ConcurrentSessionManager, StaleHandleThrows) {
+    DummyManager sess_mgr;
+    auto sess_handle = sess_mgr.new_session();
+    IGNORE_RETURN(sess_mgr.new_session());
+    sess_mgr.delete_session(sess_handle);
+    EXPECT_THROW (sess_mgr.delete_session(sess_handle), DummyManager::SessionInvalid);
+    EXPECT_EQ (sess_mgr.count(), 1);
+}
+
+TEST(ConcurrentSessionManager, FillsAllShardsUpToLimit) {
+    DummyManager sess_mgr(10);
+    for (size_t i = 0; i < 10; ++i) IGNORE_RETURN(sess_mgr.new_session());
+    EXPECT_THROW (IGNORE_RETURN(sess_mgr.new_session()), DummyManager::SessionInvalid);
+    EXPECT_EQ (sess_mgr.count(), 10);
+}
+
+TEST(ConcurrentSessionManager, ConcurrentChurnKeepsCountConsistent) {
+    DummyManager sess_mgr(0x1000);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&sess_mgr, t] {
+            std::vector<size_t> sess_handles;
+            for (int i = 0; i < 0x100; ++i) {
+                sess_handles.push_back(sess_mgr.new_session());
+                sess_mgr.visit_session(sess_handles.back(), [t] (DummyConcurrentSession & sess) { sess.i = t; });
+            }
+            for (size_t i = 0; i < sess_handles.size(); i += 2) {
+                EXPECT_EQ (sess_mgr.visit_session(sess_handles[i], [] (auto & sess) { return sess.i; }), t);
+                sess_mgr.delete_session(sess_handles[i]);
+            }
+        });
+    }
+    for (auto & worker : workers) worker.join();
+    EXPECT_EQ (sess_mgr.count(), 8 * 0x80);
+}
+
+TEST(ConcurrentSessionManager, LeaseGivesAccessToSession) {
+    DummyManager sess_mgr;
+    auto sess_handle = sess_mgr.new_session();
+    sess_mgr.visit_session(sess_handle, [] (DummyConcurrentSession & sess) { sess.i = 13; });
+    auto lease = sess_mgr.acquire_session(sess_handle);
+    EXPECT_EQ (lease->i, 13);
+}
+
+TEST(ConcurrentSessionManager, LeaseOutlivesDeletion) {
+    DummyManager sess_mgr;
+    auto sess_handle = sess_mgr.new_session();
+    IGNORE_RETURN(sess_mgr.new_session());
+    auto lease = sess_mgr.acquire_session(sess_handle);
+    lease->i = 14;
+    sess_mgr.delete_session(sess_handle);
+    EXPECT_EQ (lease->i, 14);
+    EXPECT_THROW (IGNORE_RETURN(sess_mgr.acquire_session(sess_handle)), DummyManager::SessionInvalid);
+}
+
+TEST(ConcurrentSessionManager, LeaseOutlivesManager) {
+    std::optional<ConcurrentSessionManager<CountedSession, 4>> sess_mgr(std::in_place);
+    {
+        auto lease = sess_mgr->acquire_session(sess_mgr->new_session());
+        lease->i = 15;
+        sess_mgr.reset();
+        HazardDomain<>::Scan();
+        EXPECT_EQ (CountedSession::destroyed, 0);
+        EXPECT_EQ (lease->i, 15);
+    }
+    HazardDomain<>::Scan();
+    EXPECT_EQ (CountedSession::destroyed, 1);
+}
+
+TEST(ConcurrentSessionManager, ConcurrentLeasesAndDeletes) {
+    DummyManager sess_mgr(0x1000);
+    std::vector<size_t> sess_handles;
+    for (int i = 0; i < 0x800; ++i) {
+        sess_handles.push_back(sess_mgr.new_session());
+        sess_mgr.visit_session(sess_handles.back(), [i] (DummyConcurrentSession & sess) { sess.i = i; });
+    }
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&sess_mgr, &sess_handles] {
+            for (int i = 0; i < 0x800; ++i) {
+                try {
+                    auto lease = sess_mgr.acquire_session(sess_handles[i]);
+                    EXPECT_EQ (lease->i, i);
+                } catch (const DummyManager::SessionInvalid &) {}
+            }
+        });
+    }
+    for (const auto & sess_handle : sess_handles) sess_mgr.delete_session(sess_handle);
+    for (auto & reader : readers) reader.join();
+    EXPECT_TRUE (sess_mgr.empty());
+}
+
+TEST(ConcurrentSessionManager, StatsMergeShards) {
+    ConcurrentSessionManager<DummyConcurrentSession, 4, SessionStats> sess_mgr(100);
+    std::vector<size_t> handles;
+    for (int i = 0; i < 50; ++i) handles.push_back(sess_mgr.new_session());
+    for (int i = 0; i < 10; ++i) sess_mgr.delete_session(handles[i]);
+    auto stats = sess_mgr.stats();
+    EXPECT_EQ (stats.event(SessionEvent::Created), 50);
+    EXPECT_EQ (stats.event(SessionEvent::Deleted), 10);
+    EXPECT_EQ (stats.latency(SessionOp::Delete).count(), 10);
+    EXPECT_EQ (stats.latency(SessionOp::Lookup).count(), 0); // deleting is not a lookup
+    EXPECT_EQ (stats.sessions, 40);
+    EXPECT_EQ (stats.capacity, 100);
+}
@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+#include "SimpleSignal/ConcurrentSignal.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <optional>
+
+#define IGNORE_RETURN(expr) static_cast<void>(expr)
+
+using namespace Simple;
+
+TEST(ConcurrentSignal, EmitInvokesConnectedSlots) {
+    size_t calls = 0;
+    ConcurrentSignal<void(int)> signal;
+    auto first = signal.connect([&calls] (int i) { calls += i; });
+    IGNORE_RETURN(signal.connect([&calls] (int i) { calls += 10 * i; }));
+    EXPECT_EQ (signal.size(), 2);
+    signal.emit(1);
+    EXPECT_EQ (calls, 11);
+    signal.disconnect(first);
+    signal.emit(1);
+    EXPECT_EQ (calls, 21);
+    EXPECT_THROW (signal.disconnect(first), decltype(signal)::SlotInvalid);
+}
+
+TEST(ConcurrentSignal, ConnectingExcessiveSlotThrows) {
+    ConcurrentSignal<void()> signal(1);
+    IGNORE_RETURN(signal.connect([] {}));
+    EXPECT_THROW (IGNORE_RETURN(signal.connect([] {})), decltype(signal)::SlotInvalid);
+}
+
+TEST(ConcurrentSignal, SlotMayDisconnectItselfDuringEmit) {
+    size_t calls = 0;
+    ConcurrentSignal<void()> signal;
+    std::optional<decltype(signal)::SlotHandle> self;
+    self = signal.connect([&] { calls++; signal.disconnect(*self); });
+    signal.emit(); // The running emit still owns the snapshot with the slot
+    signal.emit();
+    EXPECT_EQ (calls, 1);
+    EXPECT_EQ (signal.size(), 0);
+}
+
+TEST(ConcurrentSignal, NestedEmitIsProtected) {
+    size_t calls = 0;
+    ConcurrentSignal<void()> inner;
+    ConcurrentSignal<void()> outer;
+    IGNORE_RETURN(inner.connect([&calls] { calls++; }));
+    IGNORE_RETURN(outer.connect([&inner] { inner.emit(); }));
+    outer.emit();
+    EXPECT_EQ (calls, 1);
+}
+
+TEST(ConcurrentSignal, EmitWhileConnectingAndDisconnecting) {
+    std::atomic_size_t calls = 0;
+    ConcurrentSignal<void()> signal;
+    IGNORE_RETURN(signal.connect([&calls] { calls++; }));
+    std::atomic_bool done = false;
+    std::vector<std::thread> emitters;
+    for (int t = 0; t < 3; ++t)
+        emitters.emplace_back([&] { do signal.emit(); while (!done); });
+    for (int i = 0; i < 0x2000; ++i) {
+        auto slot_handle = signal.connect([&calls] { calls++; });
+        signal.disconnect(slot_handle);
+    }
+    done = true;
+    for (auto & emitter : emitters) emitter.join();
+    EXPECT_EQ (signal.size(), 1);
+    EXPECT_GT (calls, 0);
+}
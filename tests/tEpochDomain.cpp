@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include "HPHashMap/EpochDomain.hpp"
+#include "HPHashMap/WRRMMap.hpp"
+#include "HPHashMap/HPHashMap.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+// Every test gets a domain of its own, so records and retired objects of other tests don't interfere
+template<int Id>
+struct EpochTestTag {};
+
+template<int Id>
+struct EpochTracked {
+    static inline std::atomic_int alive{0};
+    int value;
+    explicit EpochTracked(int v) : value(v) { alive.fetch_add(1); }
+    ~EpochTracked() { alive.fetch_sub(1); }
+};
+
+TEST(EpochDomain, QuiescentObjectsAreReclaimed) {
+    using Domain = EpochDomain<EpochTestTag<1>>;
+    using Object = EpochTracked<1>;
+    for (int i = 0; i < 10; ++i) Domain::Retire(new Object(i));
+    EXPECT_EQ (Object::alive, 10);
+    EXPECT_EQ (Domain::Unreclaimed(), 10);
+    // Two epochs must pass before an object is freed
+    Domain::Scan();
+    Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+    EXPECT_EQ (Domain::Pending(), 0);
+    EXPECT_EQ (Domain::Unreclaimed(), 0);
+}
+
+TEST(EpochDomain, GuardKeepsObjectsAlive) {
+    using Domain = EpochDomain<EpochTestTag<2>>;
+    using Object = EpochTracked<2>;
+    std::atomic<Object*> shared = new Object(7);
+    std::atomic_bool entered = false, retired = false;
+    std::thread reader([&] {
+        Domain::Guard guard;
+        Object * object = guard.Protect(shared);
+        entered = true;
+        while (!retired) std::this_thread::yield();
+        EXPECT_EQ (object->value, 7);
+    });
+    while (!entered) std::this_thread::yield();
+    Domain::Retire(shared.exchange(nullptr));
+    for (int i = 0; i < 4; ++i) Domain::Scan();
+    EXPECT_EQ (Object::alive, 1);
+    retired = true;
+    reader.join();
+    for (int i = 0; i < 2; ++i) Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+}
+
+TEST(EpochDomain, NestedGuardsLeaveOnce) {
+    using Domain = EpochDomain<EpochTestTag<3>>;
+    using Object = EpochTracked<3>;
+    {
+        Domain::Guard outer;
+        {
+            Domain::Guard inner;
+        }
+        Domain::Retire(new Object(1));
+        for (int i = 0; i < 4; ++i) Domain::Scan();
+        // Still inside outer, the epoch can advance only once past our announcement
+        EXPECT_EQ (Object::alive, 1);
+    }
+    for (int i = 0; i < 2; ++i) Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+    EXPECT_EQ (Domain::Records(), 1);
+}
+
+TEST(EpochDomain, LeftoversOfExitedThreadAreAdopted) {
+    using Domain = EpochDomain<EpochTestTag<4>>;
+    using Object = EpochTracked<4>;
+    std::thread([] { Domain::Retire(new Object(1)); }).join();
+    for (int i = 0; i < 3; ++i) Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+}
+
+TEST(EpochDomain, RecordsOfExitedThreadsAreReused) {
+    using Domain = EpochDomain<EpochTestTag<5>>;
+    for (int i = 0; i < 8; ++i)
+        std::thread([] { Domain::Guard guard; }).join();
+    EXPECT_EQ (Domain::Records(), 1);
+}
+
+TEST(EpochDomain, ConcurrentReadersAndWriters) {
+    using Domain = EpochDomain<EpochTestTag<6>>;
+    using Object = EpochTracked<6>;
+    std::atomic<Object*> shared = new Object(0);
+    std::atomic_bool stop = false;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop) {
+                Domain::Guard guard;
+                EXPECT_GE (guard.Protect(shared)->value, 0);
+            }
+        });
+    }
+    for (int i = 1; i < 20000; ++i) Domain::Retire(shared.exchange(new Object(i)));
+    stop = true;
+    for (auto & reader : readers) reader.join();
+    Domain::Retire(shared.exchange(nullptr));
+    for (int i = 0; i < 3; ++i) Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+}
+
+template<typename Reclaimer>
+class ReclaimerPolicy : public ::testing::Test {};
+using Reclaimers = ::testing::Types<HazardDomain<>, EpochDomain<>>;
+TYPED_TEST_SUITE(ReclaimerPolicy, Reclaimers);
+
+TYPED_TEST(ReclaimerPolicy, WRRMMapUnderConcurrentUpdates) {
+    WRRMMap<TypeParam> map;
+    for (int t = 0; t < 4; ++t) map.Update(t, 0);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+        writers.emplace_back([&map, t] { for (int i = 0; i < 500; ++i) map.Update(t, i); });
+    for (int i = 0; i < 2000; ++i) EXPECT_LT (map.Lookup(i % 4), 500);
+    for (auto & writer : writers) writer.join();
+    for (int t = 0; t < 4; ++t) EXPECT_EQ (map.Lookup(t), 499);
+}
+
+TYPED_TEST(ReclaimerPolicy, HPHashMapUnderConcurrentUpdates) {
+    HPHashMap<int, int, std::hash<int>, std::equal_to<int>, TypeParam> map;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&map, t] {
+            for (int i = 0; i < 2000; ++i) {
+                map.Update(i % 64, t);
+                if (i % 3 == 0) map.Erase((i + 7) % 64);
+                auto value = map.Lookup(i % 64);
+                EXPECT_LT (value.value_or(0), 4);
+            }
+        });
+    }
+    for (auto & thread : threads) thread.join();
+    EXPECT_LE (map.Size(), 64);
+}
@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+#include "HPHashMap/FlatSnapshot.hpp"
+#include "HPHashMap/WRRMMap.hpp"
+
+#include <map>
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <utility>
+
+TEST(FlatSnapshot, EmptyFindsNothing) {
+    FlatSnapshot snapshot;
+    EXPECT_EQ (snapshot.Size(), 0);
+    EXPECT_FALSE (snapshot.Find(0));
+    EXPECT_FALSE (snapshot.Find(std::numeric_limits<int>::max()));
+    EXPECT_EQ (snapshot.LowerBound(5), 0);
+}
+
+TEST(FlatSnapshot, WithInsertsAndReplaces) {
+    auto snapshot = std::make_unique<FlatSnapshot>();
+    snapshot = snapshot->With(5, 50);
+    snapshot = snapshot->With(1, 10);
+    snapshot = snapshot->With(9, 90);
+    auto replaced = snapshot->With(5, 55);
+    EXPECT_EQ (snapshot->Size(), 3);
+    EXPECT_EQ (replaced->Size(), 3);
+    EXPECT_EQ (snapshot->Find(5), 50);
+    EXPECT_EQ (replaced->Find(5), 55);
+    EXPECT_EQ (replaced->Find(1), 10);
+    EXPECT_EQ (replaced->Find(9), 90);
+    EXPECT_FALSE (replaced->Find(4));
+}
+
+TEST(FlatSnapshot, ExtremeKeys) {
+    auto snapshot = std::make_unique<FlatSnapshot>();
+    snapshot = snapshot->With(std::numeric_limits<int>::max(), 1);
+    snapshot = snapshot->With(std::numeric_limits<int>::min(), 2);
+    snapshot = snapshot->With(0, 3);
+    EXPECT_EQ (snapshot->Find(std::numeric_limits<int>::max()), 1);
+    EXPECT_EQ (snapshot->Find(std::numeric_limits<int>::min()), 2);
+    EXPECT_EQ (snapshot->Find(0), 3);
+    EXPECT_FALSE (snapshot->Find(std::numeric_limits<int>::max() - 1));
+}
+
+TEST(FlatSnapshot, MatchesStdMapAcrossSizes) {
+    std::minstd_rand rng(7);
+    std::map<int, int> reference;
+    auto snapshot = std::make_unique<FlatSnapshot>();
+    for (int i = 0; i < 1000; ++i) {
+        const int k = static_cast<int>(rng() % 2000) - 1000;
+        reference[k] = i;
+        snapshot = snapshot->With(k, i);
+        ASSERT_EQ (snapshot->Size(), reference.size());
+        if (i % 37 == 0) {
+            for (int probe = -1001; probe <= 1001; ++probe) {
+                auto it = reference.lower_bound(probe);
+                ASSERT_EQ (snapshot->LowerBound(probe), static_cast<size_t>(std::distance(reference.begin(), it)));
+                ASSERT_EQ (snapshot->Find(probe), it != reference.end() && it->first == probe ? std::optional(it->second) : std::nullopt);
+            }
+        }
+    }
+}
+
+TEST(WRRMMap, FindDoesNotInsert) {
+    WRRMMap<> map;
+    map.Update(3, 30);
+    EXPECT_FALSE (map.Find(4));
+    EXPECT_EQ (map.Lookup(4), 0);
+    EXPECT_EQ (map.Size(), 1);
+    EXPECT_EQ (map.Find(3), 30);
+    EXPECT_EQ (map.Lookup(3), 30);
+}
+
+TEST(FlatSnapshot, BatchMatchesSingleUpdates) {
+    std::minstd_rand rng(11);
+    auto batched = std::make_unique<FlatSnapshot>();
+    auto single = std::make_unique<FlatSnapshot>();
+    for (int round = 0; round < 20; ++round) {
+        std::vector<std::pair<int, int>> updates;
+        for (int i = 0; i < round * 7; ++i) updates.emplace_back(static_cast<int>(rng() % 300), round * 1000 + i);
+        batched = batched->With(updates);
+        for (const auto & [k, v] : updates) single = single->With(k, v);
+        ASSERT_EQ (batched->Size(), single->Size());
+        for (int k = 0; k < 300; ++k) ASSERT_EQ (batched->Find(k), single->Find(k));
+    }
+}
+
+TEST(WRRMMap, UpdateBatchLastWins) {
+    WRRMMap<> map;
+    map.Update(1, 10);
+    const std::vector<std::pair<int, int>> updates = {{2, 20}, {1, 11}, {3, 30}, {2, 21}};
+    map.UpdateBatch(updates);
+    EXPECT_EQ (map.Size(), 3);
+    EXPECT_EQ (map.Find(1), 11);
+    EXPECT_EQ (map.Find(2), 21);
+    EXPECT_EQ (map.Find(3), 30);
+}
+
+TEST(WRRMMap, ConcurrentWritersAreCombined) {
+    WRRMMap<> map;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 8; ++t) {
+        writers.emplace_back([&map, t] {
+            for (int i = 0; i < 200; ++i) {
+                if (i % 10 == 0) {
+                    const std::vector<std::pair<int, int>> updates = {{t * 1000 + i, i}, {t * 1000 + i + 1, i + 1}};
+                    map.UpdateBatch(updates);
+                } else {
+                    map.Update(t * 1000 + i, i);
+                }
+                EXPECT_EQ (map.Find(t * 1000 + i), i);
+            }
+        });
+    }
+    for (auto & writer : writers) writer.join();
+    EXPECT_EQ (map.Size(), 8 * 200);
+    for (int t = 0; t < 8; ++t)
+        for (int i = 0; i < 200; ++i) EXPECT_EQ (map.Find(t * 1000 + i), i);
+}
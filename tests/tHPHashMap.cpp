@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+#include "HPHashMap/HPHashMap.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+struct CollidingHash {
+    size_t operator()(int) const { return 42; }
+};
+
+TEST(HPHashMap, InsertLookupErase) {
+    HPHashMap<int, std::string> map;
+    EXPECT_FALSE (map.Lookup(1));
+    EXPECT_TRUE (map.Update(1, "one"));
+    EXPECT_TRUE (map.Update(2, "two"));
+    EXPECT_EQ (map.Lookup(1), "one");
+    EXPECT_EQ (map.Lookup(2), "two");
+    EXPECT_EQ (map.Size(), 2);
+    EXPECT_TRUE (map.Erase(1));
+    EXPECT_FALSE (map.Erase(1));
+    EXPECT_FALSE (map.Lookup(1));
+    EXPECT_EQ (map.Size(), 1);
+}
+
+TEST(HPHashMap, UpdateReplacesValue) {
+    HPHashMap<int, int> map;
+    EXPECT_TRUE (map.Update(7, 1));
+    EXPECT_FALSE (map.Update(7, 2));
+    EXPECT_FALSE (map.Update(7, 3));
+    EXPECT_EQ (map.Lookup(7), 3);
+    EXPECT_EQ (map.Size(), 1);
+    EXPECT_TRUE (map.Erase(7));
+    EXPECT_FALSE (map.Lookup(7));
+}
+
+TEST(HPHashMap, GrowsPastInitialBuckets) {
+    HPHashMap<int, int> map(1);
+    for (int i = 0; i < 10000; ++i) ASSERT_TRUE (map.Update(i, i * 2));
+    for (int i = 0; i < 10000; ++i) ASSERT_EQ (map.Lookup(i), i * 2);
+    for (int i = 0; i < 10000; i += 2) ASSERT_TRUE (map.Erase(i));
+    for (int i = 0; i < 10000; ++i) ASSERT_EQ (map.Lookup(i).has_value(), i % 2 == 1);
+    EXPECT_EQ (map.Size(), 5000);
+}
+
+TEST(HPHashMap, CollidingKeysStayApart) {
+    HPHashMap<int, int, CollidingHash> map;
+    for (int i = 0; i < 100; ++i) map.Update(i, i);
+    EXPECT_TRUE (map.Erase(50));
+    EXPECT_FALSE (map.Update(51, -51));
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ (map.Lookup(i), i == 50 ? std::nullopt : std::optional<int>(i == 51 ? -51 : i));
+}
+
+TEST(HPHashMap, ConcurrentWritersAndReaders) {
+    constexpr int threads = 4, keys = 2000;
+    HPHashMap<int, int> map(2);
+    std::atomic_bool failed = false;
+    std::vector<std::jthread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&map, &failed, t] {
+            for (int round = 0; round < 3; ++round) {
+                for (int k = t; k < keys; k += threads) map.Update(k, k + round);
+                for (int k = t; k < keys; k += threads)
+                    if (map.Lookup(k) != k + round) failed = true;
+                for (int k = t; k < keys; k += 2 * threads)
+                    if (!map.Erase(k)) failed = true;
+                // other threads' keys hold one of their round values or are gone
+                for (int k = 0; k < keys; ++k)
+                    if (auto value = map.Lookup(k); value && (*value < k || *value > k + 2)) failed = true;
+            }
+        });
+    workers.clear();
+    EXPECT_FALSE (failed);
+    size_t expected = 0;
+    for (int k = 0; k < keys; ++k) {
+        const bool erased = (k % threads) == (k % (2 * threads));
+        if (!erased) expected++;
+        EXPECT_EQ (map.Lookup(k).has_value(), !erased) << k;
+    }
+    EXPECT_EQ (map.Size(), expected);
+}
+
+TEST(HPHashMap, ConcurrentUpdatesOfOneKey) {
+    HPHashMap<int, int> map;
+    std::vector<std::jthread> workers;
+    for (int t = 0; t < 4; ++t)
+        workers.emplace_back([&map, t] {
+            for (int i = 0; i < 5000; ++i) {
+                map.Update(1, t);
+                map.Update(i % 64 + 2, i);
+                if (i % 3 == 0) map.Erase(i % 64 + 2);
+            }
+        });
+    workers.clear();
+    auto value = map.Lookup(1);
+    ASSERT_TRUE (value);
+    EXPECT_GE (*value, 0);
+    EXPECT_LT (*value, 4);
+}
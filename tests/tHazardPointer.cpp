@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+#include "HPHashMap/HazardPointer.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+// Every test gets a domain of its own, so records and retired objects of other tests don't interfere
+template<int Id>
+struct TestTag {};
+
+template<int Id>
+struct Tracked {
+    static inline std::atomic_int alive{0};
+    int value;
+    explicit Tracked(int v) : value(v) { alive.fetch_add(1); }
+    ~Tracked() { alive.fetch_sub(1); }
+};
+
+TEST(HazardPointer, UnprotectedObjectsAreReclaimed) {
+    using Domain = HazardDomain<TestTag<1>>;
+    using Object = Tracked<1>;
+    for (int i = 0; i < 10; ++i) Domain::Retire(new Object(i));
+    EXPECT_EQ (Object::alive, 10);
+    Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+    EXPECT_EQ (Domain::Pending(), 0);
+}
+
+TEST(HazardPointer, ProtectedObjectSurvivesScan) {
+    using Domain = HazardDomain<TestTag<2>>;
+    using Object = Tracked<2>;
+    std::atomic<Object*> shared = new Object(7);
+    {
+        Domain::Guard guard;
+        Object * object = guard.Protect(shared);
+        Domain::Retire(shared.exchange(nullptr));
+        Domain::Scan();
+        EXPECT_EQ (Object::alive, 1);
+        EXPECT_EQ (object->value, 7);
+    }
+    Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+}
+
+TEST(HazardPointer, CustomDeleter) {
+    using Domain = HazardDomain<TestTag<3>>;
+    static int deleted = 0;
+    struct CountingDeleter {
+        void operator()(int * p) const { ++deleted; delete p; }
+    };
+    Domain::Retire(new int(1), CountingDeleter());
+    Domain::Retire(new int(2), CountingDeleter());
+    Domain::Scan();
+    EXPECT_EQ (deleted, 2);
+}
+
+TEST(HazardPointer, LeftoversOfExitedThreadAreAdopted) {
+    using Domain = HazardDomain<TestTag<4>>;
+    using Object = Tracked<4>;
+    std::atomic<Object*> shared = new Object(1);
+    Domain::Guard guard;
+    guard.Protect(shared);
+    std::thread([&shared] { Domain::Retire(shared.exchange(nullptr)); }).join();
+    EXPECT_EQ (Object::alive, 1);
+    guard.Clear();
+    Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+}
+
+TEST(HazardPointer, RecordsOfExitedThreadsAreReused) {
+    using Domain = HazardDomain<TestTag<5>>;
+    for (int i = 0; i < 8; ++i)
+        std::thread([] { Domain::Guard a, b, c; }).join();
+    EXPECT_EQ (Domain::Records(), 3);
+}
+
+TEST(HazardPointer, CachedRecordsAreReused) {
+    using Domain = HazardDomain<TestTag<6>>;
+    for (int i = 0; i < 100; ++i) {
+        Domain::Guard outer;
+        Domain::Guard inner;
+    }
+    EXPECT_EQ (Domain::Records(), 2);
+    std::vector<Domain::Guard> nested(20);
+    EXPECT_EQ (Domain::Records(), 20);
+}
+
+TEST(HazardPointer, GuardMovesAcrossThreads) {
+    using Domain = HazardDomain<TestTag<7>>;
+    using Object = Tracked<7>;
+    std::atomic<Object*> shared = new Object(3);
+    Domain::Guard guard;
+    guard.Protect(shared);
+    std::thread([moved = std::move(guard), &shared] () mutable {
+        Domain::Retire(shared.exchange(nullptr));
+        Domain::Scan();
+        EXPECT_EQ (Object::alive, 1);
+    }).join();
+    Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+}
+
+TEST(HazardPointer, ScansAreAmortised) {
+    using Domain = HazardDomain<TestTag<8>>;
+    using Object = Tracked<8>;
+    Domain::Guard guard;
+    for (int i = 0; i < 10; ++i) Domain::Retire(new Object(i));
+    EXPECT_EQ (Domain::Pending(), 10);
+    for (int i = 0; i < 10000; ++i) Domain::Retire(new Object(i));
+    EXPECT_LT (Domain::Pending(), 100);
+    EXPECT_LT (Object::alive, 100);
+}
+
+TEST(HazardPointer, ConcurrentReadersAndWriters) {
+    using Domain = HazardDomain<TestTag<9>>;
+    using Object = Tracked<9>;
+    std::atomic<Object*> shared = new Object(0);
+    std::atomic_bool stop = false;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop) {
+                Domain::Guard guard;
+                EXPECT_GE (guard.Protect(shared)->value, 0);
+            }
+        });
+    }
+    for (int i = 1; i < 20000; ++i) Domain::Retire(shared.exchange(new Object(i)));
+    stop = true;
+    for (auto & reader : readers) reader.join();
+    Domain::Retire(shared.exchange(nullptr));
+    Domain::Scan();
+    EXPECT_EQ (Object::alive, 0);
+}
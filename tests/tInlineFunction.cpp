@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include "SimpleSignal/InlineFunction.hpp"
+
+#include <array>
+#include <memory>
+#include <functional>
+
+using namespace Simple;
+
+[[gnu::noinline]] int add_one(int i) { return i + 1; }
+
+struct Counted {
+    static inline int alive = 0;
+    int * calls;
+    explicit Counted(int * calls) : calls(calls) { ++alive; }
+    Counted(Counted && other) noexcept : calls(other.calls) { ++alive; }
+    Counted(const Counted & other) : calls(other.calls) { ++alive; }
+    ~Counted() { --alive; }
+    void operator()() const { ++*calls; }
+};
+
+TEST(InlineFunction, EmptyByDefault) {
+    InlineFunction<void()> function;
+    EXPECT_FALSE (function);
+    EXPECT_FALSE (InlineFunction<int(int)>(static_cast<int(*)(int)>(nullptr)));
+    EXPECT_FALSE (InlineFunction<void()>(std::function<void()>()));
+    EXPECT_THROW (function(), std::bad_function_call);
+    InlineFunction<int(int)> moved(add_one);
+    InlineFunction<int(int)> target(std::move(moved));
+    EXPECT_TRUE (target);
+    EXPECT_THROW (moved(1), std::bad_function_call);
+}
+
+TEST(InlineFunction, CallsFunctionsAndLambdas) {
+    InlineFunction<int(int)> function(add_one);
+    EXPECT_EQ (function(1), 2);
+    int offset = 10;
+    InlineFunction<int(int)> lambda([&offset] (int i) { return i + offset; });
+    EXPECT_EQ (lambda(1), 11);
+    EXPECT_EQ (InlineFunction<int(int)>::bind<add_one>()(2), 3);
+}
+
+TEST(InlineFunction, BindsMemberFunctions) {
+    struct Accumulator {
+        int total = 0;
+        void add(int i) { total += i; }
+    } accumulator;
+    auto function = InlineFunction<void(int)>::bind<&Accumulator::add>(&accumulator);
+    function(3); function(4);
+    EXPECT_EQ (accumulator.total, 7);
+}
+
+TEST(InlineFunction, MoveTransfersTargetAndDestroysOnce) {
+    int calls = 0;
+    {
+        InlineFunction<void()> function{Counted(&calls)};
+        EXPECT_EQ (Counted::alive, 1);
+        InlineFunction<void()> moved(std::move(function));
+        EXPECT_FALSE (function);
+        EXPECT_EQ (Counted::alive, 1);
+        moved();
+        function = std::move(moved);
+        function();
+        EXPECT_EQ (Counted::alive, 1);
+    }
+    EXPECT_EQ (calls, 2);
+    EXPECT_EQ (Counted::alive, 0);
+}
+
+TEST(InlineFunction, LargeTargetsGoToTheHeap) {
+    std::array<int, 64> big{};
+    big[63] = 5;
+    auto shared = std::make_shared<int>(1);
+    {
+        InlineFunction<int()> function([big, shared] { return big[63] + *shared; });
+        InlineFunction<int()> moved(std::move(function));
+        EXPECT_EQ (moved(), 6);
+        EXPECT_EQ (shared.use_count(), 2);
+    }
+    EXPECT_EQ (shared.use_count(), 1);
+}
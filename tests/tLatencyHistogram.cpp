@@ -0,0 +1,21 @@
+#include "gtest/gtest.h"
+#include "Common/LatencyHistogram.hpp"
+
+#include <cstdint>
+
+using namespace Simple;
+
+TEST(LatencyHistogram, Percentiles) {
+    LatencyHistogram histogram;
+    for (uint64_t nanos = 1; nanos <= 1000; ++nanos) histogram.record(nanos);
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ (snapshot.count(), 1000);
+    for (double fraction : {0.5, 0.9, 0.99}) {
+        auto expected = static_cast<double>(fraction * 1000);
+        EXPECT_GE (snapshot.percentile(fraction), expected);
+        EXPECT_LE (snapshot.percentile(fraction), expected * (1 + 1.0 / LatencyHistogram::sub_count));
+    }
+    EXPECT_GE (snapshot.percentile(1.0), 1000);
+    EXPECT_EQ (LatencyHistogram().snapshot().percentile(0.5), 0);
+    EXPECT_LT (LatencyHistogram::bucket_of(UINT64_MAX), LatencyHistogram::buckets);
+}
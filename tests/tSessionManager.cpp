@@ -1,6 +1,13 @@
 #include "gtest/gtest.h"
 #include "SessionManager/SessionManager.hpp"
 
+#include <memory_resource>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <csignal>
+#include <sys/resource.h>
+
 class DummySession {
 public:
     int i = 0;
@@ -137,4 +144,397 @@ TEST(SessionManager, GetSessReturnsMutableSess) {
     EXPECT_EQ (sess_mgr.get_session(sess_handle).i, 13);
     sess.i = 14;
     EXPECT_EQ (sess_mgr.get_session(sess_handle).i, 14);
-}
\ No newline at end of file
+}
+
+TEST(SessionManager, StaleHandleThrowsAfterSlotReuse) {
+    SessionManager<DummySession> sess_mgr(1);
+    auto stale_handle = sess_mgr.new_session();
+    sess_mgr.delete_session(stale_handle);
+    auto fresh_handle = sess_mgr.new_session();
+    EXPECT_NE (stale_handle, fresh_handle);
+    EXPECT_THROW (IGNORE_RETURN(sess_mgr.get_session(stale_handle)), SessionManager<DummySession>::SessionInvalid);
+    EXPECT_NO_THROW (IGNORE_RETURN(sess_mgr.get_session(fresh_handle)));
+}
+
+TEST(SessionManager, HandlesSurviveDeletionOfOtherSessions) {
+    SessionManager<DummySession> sess_mgr;
+    std::vector<size_t> sess_handles(0xff);
+    for (uint8_t i = 0; i < 0xff; ++i) {
+        sess_handles[i] = sess_mgr.new_session();
+        sess_mgr.get_session(sess_handles[i]).i = i;
+    }
+    for (size_t i = 0; i < 0xff; i += 2) sess_mgr.delete_session(sess_handles[i]);
+    for (size_t i = 1; i < 0xff; i += 2) EXPECT_EQ (sess_mgr.get_session(sess_handles[i]).i, i);
+}
+
+TEST(SessionManager, FreedSlotsAreReusedUpToLimit) {
+    SessionManager<DummySession> sess_mgr(0xff);
+    std::vector<size_t> sess_handles(0xff);
+    for (uint8_t round = 0; round < 4; ++round) {
+        for (uint8_t i = 0; i < 0xff; ++i) sess_handles[i] = sess_mgr.new_session();
+        EXPECT_THROW (IGNORE_RETURN(sess_mgr.new_session()), SessionManager<DummySession>::SessionInvalid);
+        for (uint8_t i = 0; i < 0xff; ++i) sess_mgr.delete_session(sess_handles[i]);
+        EXPECT_TRUE (sess_mgr.empty());
+    }
+}
+
+TEST(SessionManager, IdleSessionsExpire) {
+    using namespace std::chrono_literals;
+    std::vector<size_t> expired;
+    SessionManager<DummySession> sess_mgr(default_max_sessions, 100ms, [&expired] (size_t handle, DummySession &) {
+        expired.push_back(handle);
+    });
+    auto start = SessionManager<DummySession>::Clock::now();
+    auto idle_handle = sess_mgr.new_session();
+    auto busy_handle = sess_mgr.new_session();
+    EXPECT_EQ (sess_mgr.expire_idle(start + 60ms), 0);
+    IGNORE_RETURN(sess_mgr.get_session(busy_handle));
+    EXPECT_EQ (sess_mgr.expire_idle(start + 120ms), 1);
+    EXPECT_EQ (expired, std::vector<size_t>{idle_handle});
+    EXPECT_EQ (sess_mgr.count(), 1);
+    EXPECT_EQ (sess_mgr.expire_idle(start + 200ms), 1);
+    EXPECT_TRUE (sess_mgr.empty());
+}
+
+TEST(SessionManager, AccessBetweenSweepsCountsFromAccessTime) {
+    using namespace std::chrono_literals;
+    auto start = SessionManager<DummySession>::Clock::now();
+    SessionManager<DummySession> sess_mgr(default_max_sessions, 100ms);
+    auto handle = sess_mgr.new_session();
+    EXPECT_EQ (sess_mgr.expire_idle(start + 10ms), 0);
+    std::this_thread::sleep_until(start + 30ms);
+    IGNORE_RETURN(sess_mgr.get_session(handle));
+    EXPECT_EQ (sess_mgr.expire_idle(start + 111ms), 0);
+    EXPECT_EQ (sess_mgr.count(), 1);
+}
+
+TEST(SessionManager, DeletedSessionsDoNotExpire) {
+    using namespace std::chrono_literals;
+    size_t expired = 0;
+    SessionManager<DummySession> sess_mgr(default_max_sessions, 10ms, [&expired] (size_t, DummySession &) { expired++; });
+    sess_mgr.delete_session(sess_mgr.new_session());
+    EXPECT_EQ (sess_mgr.expire_idle(SessionManager<DummySession>::Clock::now() + 1s), 0);
+    EXPECT_EQ (expired, 0);
+}
+
+class ImmovableIdSession {
+public:
+    const int id;
+    explicit ImmovableIdSession(int id) : id(id) {};
+}; // Neither default constructible nor assignable
+
+TEST(SessionManager, WorksWithNonDefaultConstructibleSessions) {
+    SessionManager<ImmovableIdSession> sess_mgr;
+    std::vector<size_t> sess_handles;
+    for (int i = 0; i < 0xff; ++i) sess_handles.push_back(sess_mgr.new_session(i));
+    for (size_t i = 0; i < sess_handles.size(); i += 3) sess_mgr.delete_session(sess_handles[i]);
+    for (size_t i = 1; i < sess_handles.size(); i += 3) EXPECT_EQ (sess_mgr.get_session(sess_handles[i]).id, i);
+}
+
+TEST(SessionManager, ChurnAfterReserveDoesNotAllocate) {
+    alignas(std::max_align_t) static std::byte arena[0x10000];
+    std::pmr::monotonic_buffer_resource pool(arena, sizeof(arena), std::pmr::null_memory_resource());
+    pmr::SessionManager<DummySession> sess_mgr(0xff, &pool);
+    sess_mgr.reserve(0xff);
+    std::vector<size_t> sess_handles(0xff);
+    EXPECT_NO_THROW ( {
+        for (uint8_t round = 0; round < 16; ++round) {
+            for (uint8_t i = 0; i < 0xff; ++i) sess_handles[i] = sess_mgr.new_session();
+            for (uint8_t i = 0; i < 0xff; ++i) sess_mgr.delete_session(sess_handles[i]);
+        }
+    });
+}
+
+class CountingResource : public std::pmr::memory_resource {
+    void * do_allocate(size_t bytes, size_t alignment) override {
+        if (allocations == limit) throw std::bad_alloc();
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void * p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+        return this == &other;
+    }
+public:
+    size_t allocations = 0;
+    size_t limit = SIZE_MAX;
+};
+
+TEST(SessionManager, IdleExpiryAllocatesFromManagerAllocator) {
+    using namespace std::chrono_literals;
+    CountingResource plain, idle;
+    pmr::SessionManager<DummySession> plain_mgr(0xff, &plain);
+    pmr::SessionManager<DummySession> idle_mgr(0xff, 100ms, {}, &idle);
+    plain_mgr.reserve(0xff);
+    idle_mgr.reserve(0xff);
+    EXPECT_EQ (idle.allocations, plain.allocations + 2); // last access ticks and wheel timers
+}
+
+TEST(SessionManager, AllocationFailureCreatesNothing) {
+    using namespace std::chrono_literals;
+    for (size_t limit = 0; limit < 32; ++limit) {
+        CountingResource resource;
+        resource.limit = limit;
+        pmr::SessionManager<DummySession> sess_mgr(0xff, 100ms, {}, &resource);
+        std::vector<size_t> sess_handles;
+        EXPECT_THROW ( {
+            for (int i = 0; i < 0xff; ++i) sess_handles.push_back(sess_mgr.new_session());
+        }, std::bad_alloc);
+        EXPECT_EQ (sess_mgr.count(), sess_handles.size());
+        resource.limit = SIZE_MAX;
+        sess_handles.push_back(sess_mgr.new_session());
+        for (size_t sess_handle : sess_handles) sess_mgr.delete_session(sess_handle);
+        EXPECT_TRUE (sess_mgr.empty());
+    }
+}
+
+TEST(SessionManager, BulkCreateAndDelete) {
+    SessionManager<DummySession> sess_mgr;
+    std::vector<size_t> sess_handles(0xff);
+    sess_mgr.new_sessions(sess_handles);
+    EXPECT_EQ (sess_mgr.count(), 0xff);
+    for (const auto & sess_handle : sess_handles) EXPECT_NO_THROW (IGNORE_RETURN(sess_mgr.get_session(sess_handle)));
+    sess_mgr.delete_sessions(sess_handles);
+    EXPECT_TRUE (sess_mgr.empty());
+}
+
+TEST(SessionManager, BulkCreateBeyondLimitCreatesNone) {
+    SessionManager<DummySession> sess_mgr(0xff);
+    std::vector<size_t> sess_handles(0x100);
+    EXPECT_THROW (sess_mgr.new_sessions(sess_handles), SessionManager<DummySession>::SessionInvalid);
+    EXPECT_TRUE (sess_mgr.empty());
+}
+
+TEST(SessionManager, ForEachVisitsEverySession) {
+    SessionManager<DummySession> sess_mgr;
+    std::vector<size_t> sess_handles(0xff);
+    sess_mgr.new_sessions(sess_handles);
+    sess_mgr.delete_session(sess_handles[7]);
+    size_t visited = 0;
+    sess_mgr.for_each_session([&] (size_t sess_handle, DummySession & sess) {
+        EXPECT_NE (sess_handle, sess_handles[7]);
+        sess.i = 1; visited++;
+    });
+    EXPECT_EQ (visited, 0xfe);
+    std::atomic_int sum = 0;
+    WorkStealingPool pool(3);
+    sess_mgr.parallel_for_each_session([&sum] (DummySession & sess) { sum += sess.i; }, pool);
+    EXPECT_EQ (sum, 0xfe);
+    EXPECT_THROW (sess_mgr.parallel_for_each_session([] (DummySession & sess) {
+        if (sess.i) throw ExpectedException();
+    }, pool), ExpectedException);
+}
+
+TEST(SessionManager, RestoreKeepsHandlesValid) {
+    auto path = std::filesystem::temp_directory_path() / "tSessionManager.snapshot";
+    std::vector<size_t> sess_handles(0xff);
+    {
+        SessionManager<DummySession> sess_mgr;
+        sess_mgr.new_sessions(sess_handles);
+        sess_mgr.attach_snapshot(path);
+        for (uint8_t i = 0; i < 0xff; ++i) sess_mgr.get_session(sess_handles[i]).i = i;
+        sess_mgr.delete_session(sess_handles[0]);
+        EXPECT_EQ (sess_mgr.snapshot(), 0xff);
+        sess_mgr.get_session(sess_handles[1]).i = 0x100;
+        EXPECT_EQ (sess_mgr.snapshot(), 0xff); // The other copy catches up with the previous snapshot
+        sess_mgr.get_session(sess_handles[1]).i = 0x100;
+        EXPECT_EQ (sess_mgr.snapshot(), 1); // Only the touched slot is rewritten
+    }
+    SessionManager<DummySession> sess_mgr;
+    sess_mgr.restore(path);
+    EXPECT_EQ (sess_mgr.count(), 0xfe);
+    EXPECT_THROW (IGNORE_RETURN(sess_mgr.get_session(sess_handles[0])), SessionManager<DummySession>::SessionInvalid);
+    EXPECT_EQ (sess_mgr.get_session(sess_handles[1]).i, 0x100);
+    for (uint8_t i = 2; i < 0xff; ++i) EXPECT_EQ (sess_mgr.get_session(sess_handles[i]).i, i);
+    EXPECT_NE (sess_mgr.new_session(), sess_handles[0]);
+    std::filesystem::remove(path);
+}
+
+TEST(SessionManager, RestoreFallsBackToPreviousSnapshot) {
+    auto path = std::filesystem::temp_directory_path() / "tSessionManager.torn.snapshot";
+    size_t kept, lost;
+    {
+        SessionManager<DummySession> sess_mgr;
+        kept = sess_mgr.new_session();
+        sess_mgr.attach_snapshot(path);
+        lost = sess_mgr.new_session();
+        sess_mgr.get_session(kept).i = 1;
+        EXPECT_EQ (sess_mgr.snapshot(), 2);
+    }
+    {
+        // Leave the latest copy half written, as a crash inside snapshot() would
+        SnapshotFile file(path, false, sizeof(DummySession), alignof(DummySession));
+        const auto latest = static_cast<unsigned>(file.latest_area());
+        file.area(latest).begin_epoch = file.next_epoch();
+        file.slot(0, latest).live = 0;
+    }
+    SessionManager<DummySession> sess_mgr;
+    sess_mgr.restore(path);
+    EXPECT_EQ (sess_mgr.count(), 1);
+    EXPECT_EQ (sess_mgr.get_session(kept).i, 0);
+    EXPECT_THROW (IGNORE_RETURN(sess_mgr.get_session(lost)), SessionManager<DummySession>::SessionInvalid);
+    EXPECT_EQ (sess_mgr.snapshot(), 1); // The torn copy is rewritten completely
+    std::filesystem::remove(path);
+}
+
+TEST(SessionManager, RestoreRejectsForeignSnapshot) {
+    auto path = std::filesystem::temp_directory_path() / "tSessionManager.foreign.snapshot";
+    {
+        SessionManager<DummySession> sess_mgr;
+        IGNORE_RETURN(sess_mgr.new_session());
+        sess_mgr.attach_snapshot(path);
+    }
+    struct WiderSession { int i, j; };
+    SessionManager<WiderSession> wider_mgr;
+    EXPECT_THROW (wider_mgr.restore(path), SnapshotFile::SnapshotInvalid);
+    struct alignas(8) AlignedSession { int i; char tail[4]; }; // same size as WiderSession, laid out differently
+    {
+        SessionManager<WiderSession> sess_mgr;
+        IGNORE_RETURN(sess_mgr.new_session());
+        sess_mgr.attach_snapshot(path);
+    }
+    SessionManager<AlignedSession> aligned_mgr;
+    EXPECT_THROW (aligned_mgr.restore(path), SnapshotFile::SnapshotInvalid);
+    std::filesystem::remove(path);
+}
+
+TEST(SessionManager, RestoredSessionsIdleFromRestoreTime) {
+    using namespace std::chrono_literals;
+    auto path = std::filesystem::temp_directory_path() / "tSessionManager.idle.snapshot";
+    {
+        SessionManager<DummySession> sess_mgr;
+        IGNORE_RETURN(sess_mgr.new_session());
+        sess_mgr.attach_snapshot(path);
+    }
+    SessionManager<DummySession> sess_mgr(default_max_sessions, 100ms);
+    std::this_thread::sleep_for(150ms);
+    sess_mgr.restore(path);
+    const auto restored = SessionManager<DummySession>::Clock::now();
+    EXPECT_EQ (sess_mgr.expire_idle(restored + 50ms), 0);
+    EXPECT_EQ (sess_mgr.expire_idle(restored + 150ms), 1);
+    std::filesystem::remove(path);
+}
+
+TEST(SessionManager, FailedRestoreLeavesManagerUnchanged) {
+    using namespace std::chrono_literals;
+    auto path = std::filesystem::temp_directory_path() / "tSessionManager.alloc.snapshot";
+    {
+        SessionManager<DummySession> sess_mgr;
+        std::vector<size_t> sess_handles(0x40);
+        sess_mgr.new_sessions(sess_handles);
+        sess_mgr.attach_snapshot(path);
+    }
+    for (size_t limit = 0;; ++limit) {
+        CountingResource resource;
+        pmr::SessionManager<DummySession> sess_mgr(0xff, 100ms, {}, &resource);
+        std::vector<size_t> sess_handles(0x10);
+        sess_mgr.new_sessions(sess_handles);
+        sess_mgr.delete_sessions(sess_handles);
+        resource.limit = resource.allocations + limit;
+        try {
+            sess_mgr.restore(path);
+            EXPECT_EQ (sess_mgr.count(), 0x40);
+            break;
+        } catch (const std::bad_alloc &) {}
+        EXPECT_TRUE (sess_mgr.empty());
+        for (size_t sess_handle : sess_handles)
+            EXPECT_THROW (IGNORE_RETURN(sess_mgr.get_session(sess_handle)), pmr::SessionManager<DummySession>::SessionInvalid);
+        resource.limit = SIZE_MAX;
+        EXPECT_LT (pmr::SessionManager<DummySession>::handle_index(sess_mgr.new_session()), 0x10); // freed slots kept
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(SessionManager, FailedSnapshotGrowthKeepsFileMapped) {
+    auto path = std::filesystem::temp_directory_path() / "tSessionManager.limited.snapshot";
+    SnapshotFile file(path, true, sizeof(DummySession), alignof(DummySession));
+    file.reserve(1);
+    file.slot(0, 0).generation = 7;
+    rlimit saved{};
+    ASSERT_EQ (getrlimit(RLIMIT_FSIZE, &saved), 0);
+    rlimit limited = saved;
+    limited.rlim_cur = 0x10000;
+    auto handler = std::signal(SIGXFSZ, SIG_IGN); // ftruncate past the limit fails with EFBIG instead
+    ASSERT_EQ (setrlimit(RLIMIT_FSIZE, &limited), 0);
+    EXPECT_THROW (file.reserve(0x100000), std::system_error);
+    setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, handler);
+    EXPECT_EQ (file.header().capacity, 1);
+    EXPECT_EQ (file.slot(0, 0).generation, 7);
+    file.reserve(2);
+    EXPECT_EQ (file.slot(0, 0).generation, 7);
+    std::filesystem::remove(path);
+}
+
+template<typename HandleGen>
+void expect_reuse_rejects_stale_handles() {
+    SessionManager<DummySession, std::allocator<DummySession>, HandleGen> sess_mgr(1);
+    std::vector<size_t> stale_handles;
+    for (uint8_t i = 0; i < 0xff; ++i) {
+        auto sess_handle = sess_mgr.new_session();
+        for (const auto & stale_handle : stale_handles) EXPECT_NE (stale_handle, sess_handle);
+        sess_mgr.delete_session(sess_handle);
+        stale_handles.push_back(sess_handle);
+    }
+}
+
+TEST(SessionManager, AllHandleGeneratorsRejectStaleHandles) {
+    expect_reuse_rejects_stale_handles<SecureHandleGenerator>();
+    expect_reuse_rejects_stale_handles<FastHandleGenerator>();
+    expect_reuse_rejects_stale_handles<Mt19937HandleGenerator>();
+}
+
+TEST(SessionManager, SecureHandleGeneratorIsThreadSafe) {
+    std::vector<std::vector<uint32_t>> values(4);
+    std::vector<std::thread> workers;
+    for (auto & thread_values : values)
+        workers.emplace_back([&thread_values] {
+            for (int i = 0; i < 0x1000; ++i) thread_values.push_back(SecureHandleGenerator::next());
+        });
+    for (auto & worker : workers) worker.join();
+    std::vector<uint32_t> all;
+    for (const auto & thread_values : values) all.insert(all.end(), thread_values.begin(), thread_values.end());
+    std::sort(all.begin(), all.end());
+    EXPECT_GT (std::unique(all.begin(), all.end()) - all.begin(), 0x3ff0); // Collisions are rare, not impossible
+}
+
+TEST(SessionManager, StatsCountEventsAndOccupancy) {
+    SessionManager<DummySession, std::allocator<DummySession>, SecureHandleGenerator, SessionStats> sess_mgr(4);
+    auto first = sess_mgr.new_session();
+    auto second = sess_mgr.new_session();
+    EXPECT_NO_THROW (IGNORE_RETURN(sess_mgr.get_session(first)));
+    sess_mgr.delete_session(second);
+    EXPECT_THROW (IGNORE_RETURN(sess_mgr.get_session(second)), decltype(sess_mgr)::SessionInvalid);
+    auto third = sess_mgr.new_session();
+    std::array<size_t, 3> handles{};
+    EXPECT_THROW (sess_mgr.new_sessions(std::span<size_t>(handles)), decltype(sess_mgr)::SessionInvalid);
+    sess_mgr.delete_session(third);
+
+    auto stats = sess_mgr.stats();
+    EXPECT_EQ (stats.event(SessionEvent::Created), 3);
+    EXPECT_EQ (stats.event(SessionEvent::Deleted), 2);
+    EXPECT_EQ (stats.event(SessionEvent::SlotReused), 1);
+    EXPECT_EQ (stats.event(SessionEvent::LookupMiss), 1);
+    EXPECT_EQ (stats.event(SessionEvent::Full), 1);
+    EXPECT_EQ (stats.latency(SessionOp::Create).count(), 3);
+    EXPECT_EQ (stats.latency(SessionOp::Lookup).count(), 1);
+    EXPECT_EQ (stats.latency(SessionOp::Delete).count(), 2);
+    EXPECT_EQ (stats.sessions, 1);
+    EXPECT_EQ (stats.slots, 2);
+    EXPECT_EQ (stats.free_slots, 1);
+    EXPECT_DOUBLE_EQ (stats.occupancy(), 0.25);
+}
+
+TEST(SessionManager, StatsTimeBatchesPerSession) {
+    SessionManager<DummySession, std::allocator<DummySession>, SecureHandleGenerator, SessionStats> sess_mgr;
+    std::vector<size_t> handles(10);
+    sess_mgr.new_sessions(std::span<size_t>(handles));
+    sess_mgr.delete_sessions(std::span<const size_t>(handles.data(), 4));
+    EXPECT_THROW (sess_mgr.delete_sessions(std::span<const size_t>(handles.data() + 3, 3)), decltype(sess_mgr)::SessionInvalid);
+    auto stats = sess_mgr.stats();
+    EXPECT_EQ (stats.latency(SessionOp::Create).count(), 10);
+    EXPECT_EQ (stats.latency(SessionOp::Delete).count(), 4);
+    EXPECT_EQ (stats.event(SessionEvent::Deleted), 4);
+}
@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include "SimpleSignal/SimpleSignal.hpp"
+
+#include <array>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sstream>
+
+using namespace Simple;
+
+#define IGNORE_RETURN(expr) static_cast<void>(expr)
+
+using ProfiledSignal = Signal<void(int), default_inline_slots, SignalProfiler>;
+
+template<class SignalType>
+concept Profiled = requires (const SignalType & signal) { signal.emit_profile(); };
+
+TEST(SignalProfiler, CompilesOutByDefault) {
+    static_assert(!Profiled<Signal<void(int)>>);
+    static_assert(Profiled<ProfiledSignal>);
+    EXPECT_EQ (sizeof(Signal<void(int)>), sizeof(Signal<void(int), default_inline_slots, NullSignalProfiler>));
+}
+
+TEST(SignalProfiler, CountsCallsPerSlot) {
+    ProfiledSignal signal;
+    int total = 0;
+    auto first = signal.connect([&total] (int value) { total += value; });
+    auto second = signal.connect([&total] (int value) { total -= value; });
+    for (int i = 0; i < 10; ++i) signal.emit(1);
+    signal.disconnect(second);
+    for (int i = 0; i < 5; ++i) signal.emit(1);
+    EXPECT_EQ (signal.slot_profile(first).count(), 15);
+    EXPECT_EQ (signal.slot_profile(second).count(), 10);
+    EXPECT_EQ (signal.emit_profile().count(), 15);
+    EXPECT_EQ (total, 5);
+}
+
+TEST(SignalProfiler, ReusedSlotStartsOver) {
+    ProfiledSignal signal;
+    auto first = signal.connect([] (int) {});
+    signal.emit(0);
+    signal.disconnect(first);
+    EXPECT_EQ (signal.slot_profile(first).count(), 1);
+    auto second = signal.connect([] (int) {}); // takes over the slot table entry
+    signal.emit(0);
+    signal.emit(0);
+    EXPECT_EQ (signal.slot_profile(first).count(), 0);
+    EXPECT_EQ (signal.slot_profile(second).count(), 2);
+}
+
+TEST(SignalProfiler, FindsTheSlowSlot) {
+    ProfiledSignal signal;
+    auto fast = signal.connect([] (int) {});
+    auto slow = signal.connect([] (int) { std::this_thread::sleep_for(std::chrono::microseconds(200)); });
+    for (int i = 0; i < 5; ++i) signal.emit(0);
+    EXPECT_GE (signal.slot_profile(slow).percentile(0.5), 200'000);
+    EXPECT_LT (signal.slot_profile(fast).percentile(0.5), signal.slot_profile(slow).percentile(0.5));
+    EXPECT_GE (signal.emit_profile().percentile(0.5), 200'000);
+}
+
+TEST(SignalProfiler, MergesThreadBuffers) {
+    ProfiledSignal signal;
+    auto slot_handle = signal.connect([] (int) {});
+    std::vector<std::jthread> emitters;
+    for (int thread = 0; thread < 4; ++thread)
+        emitters.emplace_back([&signal] { for (int i = 0; i < 100; ++i) signal.emit(0); });
+    emitters.clear();
+    WorkStealingPool pool(2);
+    signal.emit_parallel(pool, 0, 0);
+    EXPECT_EQ (signal.slot_profile(slot_handle).count(), 401);
+    EXPECT_EQ (signal.emit_profile().count(), 401);
+}
+
+TEST(SignalProfiler, ManySignalsShareThreads) {
+    std::array<ProfiledSignal, 20> signals;
+    std::vector<ProfiledSignal::SlotHandle> slot_handles;
+    for (auto & signal : signals) slot_handles.push_back(signal.connect([] (int) {}));
+    std::vector<std::jthread> emitters;
+    for (int thread = 0; thread < 3; ++thread)
+        emitters.emplace_back([&signals] { for (int i = 0; i < 10; ++i) for (auto & signal : signals) signal.emit(0); });
+    emitters.clear();
+    for (size_t i = 0; i < signals.size(); ++i) {
+        EXPECT_EQ (signals[i].slot_profile(slot_handles[i]).count(), 30);
+        EXPECT_EQ (signals[i].emit_profile().count(), 30);
+    }
+}
+
+TEST(SignalProfiler, DumpsConnectedSlots) {
+    ProfiledSignal signal;
+    IGNORE_RETURN(signal.connect([] (int) {}));
+    IGNORE_RETURN(signal.connect_batch([] (std::span<const std::tuple<int>>) {}));
+    signal.emit(0);
+    std::ostringstream out;
+    signal.dump_profile(out);
+    const std::string dump = out.str();
+    EXPECT_EQ (std::count(dump.begin(), dump.end(), '\n'), 3);
+    EXPECT_EQ (dump.rfind("emit calls 1 ", 0), 0u);
+    EXPECT_NE (dump.find("slot 1#"), std::string::npos);
+}
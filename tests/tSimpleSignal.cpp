@@ -2,8 +2,16 @@
 #include "SimpleSignal/SimpleSignal.hpp"
 
 #include <vector>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <string>
+#include <utility>
+#include <atomic>
+#include <thread>
 #include <chrono>
 #include <cmath>
+#include <memory_resource>
 
 class ExpectedException : std::exception {};
 class UnexpectedException : std::exception {};
@@ -146,6 +154,236 @@ TEST(SimpleSignal, SignalWorkWithObjectPointers) {
     }
 }
 
+TEST(SimpleSignal, EmitSkipsDisconnectedSlots) {
+    std::vector<size_t> calls(100);
+    Signal<void()> signal(100);
+    std::vector<decltype(signal)::SlotHandle> slot_handles;
+    for (size_t i = 0; i < calls.size(); ++i)
+        slot_handles.push_back(signal.connect([&calls, i] { calls[i]++; }));
+    for (size_t i = 0; i < calls.size(); i += 3) signal.disconnect(slot_handles[i]);
+    signal.emit();
+    for (size_t i = 0; i < calls.size(); ++i) EXPECT_EQ (calls[i], i % 3 ? 1 : 0);
+    for (size_t i = 1; i < calls.size(); i += 3) signal.disconnect(slot_handles[i]); // Handles survive swap-remove
+    EXPECT_EQ (signal.size(), 33);
+}
+
+TEST(SimpleSignal, StaleHandleDoesNotDisconnectNewSlot) {
+    Signal<decltype(dummy_cb)> signal(1);
+    auto stale_handle = signal.connect(dummy_cb);
+    signal.disconnect(stale_handle);
+    IGNORE_RETURN(signal.connect(dummy_cb)); // Reuses the freed slot
+    EXPECT_THROW (signal.disconnect(stale_handle), decltype(signal)::SlotInvalid);
+    EXPECT_EQ (signal.size(), 1);
+}
+
+TEST(SimpleSignal, HandlesSurviveSignalMove) {
+    Signal<decltype(dummy_cb)> signal;
+    auto slot_handle = signal.connect(dummy_cb);
+    Signal<decltype(dummy_cb)> moved(std::move(signal));
+    global = 0; moved.emit();
+    EXPECT_EQ (global, 1);
+    EXPECT_NO_THROW (moved.disconnect(slot_handle));
+    EXPECT_EQ (moved.size(), 0);
+}
+
+TEST(SimpleSignal, MovedFromSignalCanConnectAgain) {
+    Signal<decltype(dummy_cb)> signal;
+    IGNORE_RETURN(signal.connect(dummy_cb));
+    signal.disconnect(signal.connect(dummy_cb)); // leaves a free slot table entry behind
+    Signal<decltype(dummy_cb)> moved(std::move(signal));
+    auto slot_handle = signal.connect(dummy_cb);
+    EXPECT_EQ (signal.size(), 1);
+    moved.disconnect(moved.connect(dummy_cb));
+    signal = std::move(moved);
+    EXPECT_EQ (signal.size(), 1);
+    EXPECT_THROW (signal.disconnect(slot_handle), decltype(signal)::SlotInvalid);
+    slot_handle = moved.connect(dummy_cb);
+    global = 0; moved.emit();
+    EXPECT_EQ (global, 1);
+    EXPECT_NO_THROW (moved.disconnect(slot_handle));
+}
+
+TEST(SimpleSignal, SignalWorkWithStaticBindings) {
+    Obj o; o.variable = 0;
+    Signal<void()> signal;
+    IGNORE_RETURN(signal.connect<dummy_cb>());
+    IGNORE_RETURN(signal.connect_slot<&Obj::dummy_cb>(o));
+    auto slot_handle = signal.connect_slot<&Obj::dummy_cb>(&o);
+    global = 0; signal.emit();
+    EXPECT_EQ (global, 1);
+    EXPECT_EQ (o.variable, 2);
+    signal.disconnect(slot_handle);
+    signal.emit();
+    EXPECT_EQ (o.variable, 3);
+}
+
+TEST(SimpleSignal, SlotsSpillFromInlineStorage) {
+    size_t calls = 0;
+    Signal<void(), 1> signal;
+    std::vector<decltype(signal)::SlotHandle> slot_handles;
+    for (int i = 0; i < 10; ++i) slot_handles.push_back(signal.connect([&calls] { calls++; }));
+    Signal<void(), 1> moved(std::move(signal));
+    moved.emit();
+    EXPECT_EQ (calls, 10);
+    for (const auto & slot_handle : slot_handles) moved.disconnect(slot_handle);
+    EXPECT_EQ (moved.size(), 0);
+}
+
+TEST(SimpleSignal, EmitBatchRunsSlotBySlot) {
+    std::vector<std::pair<int, int>> calls;
+    Signal<void(int)> signal;
+    IGNORE_RETURN(signal.connect([&calls] (int value) { calls.emplace_back(1, value); }));
+    IGNORE_RETURN(signal.connect([&calls] (int value) { calls.emplace_back(2, value); }));
+    std::vector<Signal<void(int)>::Event> events{{10}, {20}, {30}};
+    signal.emit_batch(events);
+    const std::vector<std::pair<int, int>> expected{{1, 10}, {1, 20}, {1, 30}, {2, 10}, {2, 20}, {2, 30}};
+    EXPECT_EQ (calls, expected);
+}
+
+TEST(SimpleSignal, EmitBatchPassesReferences) {
+    Signal<void(int &, const std::string &)> signal;
+    IGNORE_RETURN(signal.connect([] (int & total, const std::string & text) { total += static_cast<int>(text.size()); }));
+    int first = 0, second = 0;
+    const std::string hello("hello"), hi("hi");
+    std::vector<decltype(signal)::Event> events{{first, hello}, {second, hi}, {first, hi}};
+    signal.emit_batch(events);
+    EXPECT_EQ (first, 7);
+    EXPECT_EQ (second, 2);
+}
+
+TEST(SimpleSignal, BatchHandlerReceivesWholeBatch) {
+    std::vector<size_t> batch_sizes;
+    int sum = 0;
+    Signal<void(int)> signal;
+    auto slot_handle = signal.connect_batch([&] (std::span<const std::tuple<int>> events) {
+        batch_sizes.push_back(events.size());
+        for (const auto & [value] : events) sum += value;
+    });
+    EXPECT_EQ (signal.size(), 1);
+    std::vector<std::tuple<int>> events{{1}, {2}, {3}};
+    signal.emit_batch(events);
+    signal.emit(4);
+    EXPECT_EQ (batch_sizes, std::vector<size_t>({3, 1}));
+    EXPECT_EQ (sum, 10);
+    signal.disconnect(slot_handle);
+    signal.emit_batch(events);
+    EXPECT_EQ (sum, 10);
+    EXPECT_EQ (signal.size(), 0);
+}
+
+TEST(SimpleSignal, BatchAndPlainSlotsShareHandles) {
+    size_t plain = 0, batched = 0;
+    Signal<void()> signal(3);
+    auto first = signal.connect([&plain] { plain++; });
+    auto second = signal.connect_batch([&batched] (std::span<const std::tuple<>> events) { batched += events.size(); });
+    auto third = signal.connect([&plain] { plain++; });
+    EXPECT_THROW (IGNORE_RETURN(signal.connect_batch(nullptr)), decltype(signal)::SlotInvalid);
+    signal.disconnect(first);
+    EXPECT_THROW (signal.disconnect(first), decltype(signal)::SlotInvalid);
+    std::vector<std::tuple<>> events(5);
+    signal.emit_batch(events);
+    EXPECT_EQ (plain, 5);
+    EXPECT_EQ (batched, 5);
+    signal.disconnect(second);
+    signal.disconnect(third);
+    EXPECT_EQ (signal.size(), 0);
+}
+
+TEST(SimpleSignal, MoveOnlyArguments) {
+    int received = 0;
+    Signal<void(std::unique_ptr<int>)> owning;
+    IGNORE_RETURN(owning.connect([&received] (std::unique_ptr<int> value) { received = *value; }));
+    owning.emit(std::make_unique<int>(5));
+    EXPECT_EQ (received, 5);
+    Signal<void(int &&)> forwarding;
+    IGNORE_RETURN(forwarding.connect([&received] (int && value) { received = value; }));
+    forwarding.emit(7);
+    EXPECT_EQ (received, 7);
+}
+
+TEST(SimpleSignal, SlotStorageUsesAllocator) {
+    alignas(std::max_align_t) static std::byte arena[0x1000];
+    std::pmr::monotonic_buffer_resource pool(arena, sizeof(arena), std::pmr::null_memory_resource());
+    Signal<void(int), default_inline_slots, NullSignalProfiler, std::pmr::polymorphic_allocator<std::byte>> signal(
+        default_max_callbacks, {}, &pool);
+    int sum = 0;
+    for (int i = 0; i < 16; ++i) IGNORE_RETURN(signal.connect([&sum] (int value) { sum += value; }));
+    signal.emit(1);
+    EXPECT_EQ (sum, 16);
+    EXPECT_EQ (signal.get_allocator().resource(), &pool);
+}
+
+class LimitedResource : public std::pmr::memory_resource {
+    void * do_allocate(size_t bytes, size_t alignment) override {
+        if (allocations == limit) throw std::bad_alloc();
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void * p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+        return this == &other;
+    }
+public:
+    size_t allocations = 0;
+    size_t limit = SIZE_MAX;
+};
+
+TEST(SimpleSignal, AllocationFailureConnectsNothing) {
+    for (size_t limit = 0; limit < 16; ++limit) {
+        LimitedResource resource;
+        resource.limit = limit;
+        Signal<void(), 1, NullSignalProfiler, std::pmr::polymorphic_allocator<std::byte>> signal(
+            default_max_callbacks, {}, &resource);
+        size_t calls = 0;
+        std::vector<decltype(signal)::SlotHandle> slot_handles;
+        EXPECT_THROW ( {
+            for (int i = 0; i < 64; ++i) {
+                if (i % 3) slot_handles.push_back(signal.connect([&calls] { calls++; }));
+                else slot_handles.push_back(signal.connect_batch([&calls] (std::span<const std::tuple<>> events) {
+                    calls += events.size();
+                }));
+            }
+        }, std::bad_alloc);
+        EXPECT_EQ (signal.size(), slot_handles.size());
+        signal.emit();
+        EXPECT_EQ (calls, slot_handles.size());
+        resource.limit = SIZE_MAX;
+        slot_handles.push_back(signal.connect([&calls] { calls++; }));
+        for (const auto & slot_handle : slot_handles) signal.disconnect(slot_handle);
+        EXPECT_EQ (signal.size(), 0);
+    }
+}
+
+TEST(SimpleSignal, EmitParallelInvokesEverySlotOnce) {
+    WorkStealingPool pool(3);
+    Signal<void(int), 2> signal(500);
+    std::vector<std::atomic_int> hits(300);
+    for (auto & hit : hits) IGNORE_RETURN(signal.connect([&hit] (int value) { hit.fetch_add(value); }));
+    std::atomic_int batched = 0;
+    IGNORE_RETURN(signal.connect_batch([&batched] (std::span<const std::tuple<int>> events) {
+        batched.fetch_add(std::get<0>(events[0]));
+    }));
+    signal.emit_parallel(pool, 0, 2);
+    for (const auto & hit : hits) EXPECT_EQ (hit.load(), 2);
+    EXPECT_EQ (batched.load(), 2);
+    signal.emit_parallel(3);
+    for (const auto & hit : hits) EXPECT_EQ (hit.load(), 5);
+    EXPECT_EQ (batched.load(), 5);
+}
+
+TEST(SimpleSignal, EmitParallelBelowThresholdIsSerial) {
+    WorkStealingPool pool(3);
+    const auto caller = std::this_thread::get_id();
+    size_t calls = 0;
+    Signal<void()> signal;
+    for (int i = 0; i < 8; ++i)
+        IGNORE_RETURN(signal.connect([&] { EXPECT_EQ (std::this_thread::get_id(), caller); calls++; }));
+    signal.emit_parallel(pool, 9);
+    EXPECT_EQ (calls, 8);
+}
+
 [[gnu::noinline]] void cdummy_cb() { global += sqrt(15) + pow(10, -3); } // complex
 
 size_t count_micros(const std::function<void()> &cbf) {
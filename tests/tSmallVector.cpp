@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+#include "SimpleSignal/SmallVector.hpp"
+
+#include <memory>
+#include <string>
+#include <memory_resource>
+
+using namespace Simple;
+
+TEST(SmallVector, StaysInlineUpToN) {
+    SmallVector<int, 4> vector;
+    for (int i = 0; i < 4; ++i) vector.push_back(i);
+    EXPECT_EQ (vector.capacity(), 4);
+    vector.push_back(4);
+    EXPECT_EQ (vector.capacity(), 8);
+    for (int i = 0; i < 5; ++i) EXPECT_EQ (vector[i], i);
+}
+
+TEST(SmallVector, MoveKeepsElementsAndEmptiesSource) {
+    for (int count : {2, 20}) { // inline and heap storage
+        SmallVector<std::string, 2> source;
+        for (int i = 0; i < count; ++i) source.emplace_back(std::to_string(i));
+        SmallVector<std::string, 2> moved(std::move(source));
+        EXPECT_TRUE (source.empty());
+        ASSERT_EQ (moved.size(), count);
+        EXPECT_EQ (moved.back(), std::to_string(count - 1));
+        source = std::move(moved);
+        EXPECT_EQ (source.size(), count);
+        EXPECT_TRUE (moved.empty());
+    }
+}
+
+TEST(SmallVector, DestroysEveryElement) {
+    auto shared = std::make_shared<int>(0);
+    {
+        SmallVector<std::shared_ptr<int>, 2> vector;
+        for (int i = 0; i < 10; ++i) vector.push_back(shared);
+        vector.pop_back();
+        EXPECT_EQ (shared.use_count(), 10);
+    }
+    EXPECT_EQ (shared.use_count(), 1);
+}
+
+TEST(SmallVector, PushingOwnElementWhileGrowing) {
+    SmallVector<std::string, 1> vector;
+    vector.emplace_back("self");
+    vector.push_back(vector.back());
+    EXPECT_EQ (vector[1], "self");
+}
+
+TEST(SmallVector, AllocatesThroughAllocator) {
+    std::pmr::monotonic_buffer_resource first, second;
+    SmallVector<int, 2, std::pmr::polymorphic_allocator<int>> source(&first);
+    for (int i = 0; i < 20; ++i) source.push_back(i);
+    SmallVector<int, 2, std::pmr::polymorphic_allocator<int>> other(&second);
+    other = std::move(source); // unequal allocators, the elements are moved into other's own buffer
+    EXPECT_TRUE (source.empty());
+    EXPECT_EQ (other.get_allocator().resource(), &second);
+    ASSERT_EQ (other.size(), 20);
+    for (int i = 0; i < 20; ++i) EXPECT_EQ (other[i], i);
+}
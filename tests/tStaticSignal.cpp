@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+#include "SimpleSignal/StaticSignal.hpp"
+
+#include <string>
+
+using namespace Simple;
+
+static size_t static_global = 0;
+void add_once(int i) { static_global += i; }
+void add_twice(int i) { static_global += 2 * i; }
+
+// Code written against the emit calling convention works with either signal type
+template<class AnySignal>
+void publish(const AnySignal & signal, int value) {
+    signal.emit(std::move(value));
+}
+
+TEST(StaticSignal, EmitInvokesEverySlot) {
+    StaticSignal<void(int), add_once, add_twice, [] (int i) { static_global += 10 * i; }> signal;
+    static_assert(decltype(signal)::size() == 3);
+    static_global = 0;
+    signal.emit(1);
+    EXPECT_EQ (static_global, 13);
+}
+
+TEST(StaticSignal, EmptySignalDoesNothing) {
+    StaticSignal<void(int)> signal;
+    static_assert(decltype(signal)::size() == 0);
+    static_global = 0;
+    signal.emit(1);
+    EXPECT_EQ (static_global, 0);
+}
+
+TEST(StaticSignal, InterchangeableWithSignal) {
+    Signal<void(int)> dynamic;
+    static_cast<void>(dynamic.connect(add_once));
+    static_cast<void>(dynamic.connect(add_twice));
+    StaticSignal<void(int), add_once, add_twice> fixed;
+    static_global = 0;
+    publish(dynamic, 1);
+    size_t dynamic_total = static_global;
+    static_global = 0;
+    publish(fixed, 1);
+    EXPECT_EQ (static_global, dynamic_total);
+}
+
+TEST(StaticSignal, ReferenceArgumentsReachSlots) {
+    StaticSignal<void(std::string &), [] (std::string & s) { s += 'a'; }, [] (std::string & s) { s += 'b'; }> signal;
+    std::string s;
+    signal.emit(s);
+    EXPECT_EQ (s, "ab");
+}
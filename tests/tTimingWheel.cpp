@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+#include "SessionManager/TimingWheel.hpp"
+
+#include <vector>
+
+using namespace Simple;
+
+TEST(TimingWheel, FiresExactlyAtDeadline) {
+    TimingWheel wheel;
+    std::vector<TimingWheel::Tick> fired(3, 0);
+    wheel.schedule(0, 5);
+    wheel.schedule(1, 300);      // second level
+    wheel.schedule(2, 70000);    // third level
+    auto record = [&fired] (uint32_t id, TimingWheel::Tick tick) { fired[id] = tick; };
+    wheel.advance(4, record);
+    EXPECT_EQ (fired[0], 0);
+    wheel.advance(100000, record);
+    EXPECT_EQ (fired[0], 5);
+    EXPECT_EQ (fired[1], 300);
+    EXPECT_EQ (fired[2], 70000);
+    EXPECT_TRUE (wheel.empty());
+}
+
+TEST(TimingWheel, CancelledTimerDoesNotFire) {
+    TimingWheel wheel;
+    size_t fired = 0;
+    wheel.schedule(7, 10);
+    wheel.cancel(7);
+    wheel.advance(20, [&fired] (uint32_t, TimingWheel::Tick) { fired++; });
+    EXPECT_EQ (fired, 0);
+    EXPECT_FALSE (wheel.scheduled(7));
+}
+
+TEST(TimingWheel, RescheduleFromCallbackFiresAgain) {
+    TimingWheel wheel;
+    std::vector<TimingWheel::Tick> ticks;
+    wheel.schedule(0, 10);
+    wheel.advance(1000, [&] (uint32_t id, TimingWheel::Tick tick) {
+        ticks.push_back(tick);
+        if (ticks.size() < 3) wheel.schedule(id, tick + 256);
+    });
+    EXPECT_EQ (ticks, (std::vector<TimingWheel::Tick>{10, 266, 522}));
+}
@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+#include "Common/WorkStealingPool.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Simple;
+
+TEST(WorkStealingPool, RunsEveryIterationOnce) {
+    WorkStealingPool pool(3);
+    for (size_t count : {0, 1, 2, 7, 64, 1000, 4099}) {
+        std::unique_ptr<std::atomic_int[]> hits(new std::atomic_int[count]());
+        pool.run(count, [&hits] (size_t i) { hits[i].fetch_add(1); });
+        for (size_t i = 0; i < count; ++i) ASSERT_EQ (hits[i].load(), 1) << "count " << count << " index " << i;
+    }
+}
+
+TEST(WorkStealingPool, BalancesUnevenIterations) {
+    WorkStealingPool pool(3);
+    std::atomic_size_t sum = 0;
+    pool.run(256, [&sum] (size_t i) {
+        if (i < 8) std::this_thread::sleep_for(std::chrono::milliseconds(1)); // the first part is slow
+        sum.fetch_add(i);
+    });
+    EXPECT_EQ (sum.load(), 255 * 256 / 2);
+}
+
+TEST(WorkStealingPool, WithoutWorkersRunsOnCaller) {
+    WorkStealingPool pool(0);
+    const auto caller = std::this_thread::get_id();
+    size_t calls = 0;
+    pool.run(100, [&] (size_t) { EXPECT_EQ (std::this_thread::get_id(), caller); calls++; });
+    EXPECT_EQ (calls, 100);
+}
+
+TEST(WorkStealingPool, NestedRunIsSerial) {
+    WorkStealingPool pool(2);
+    std::atomic_size_t calls = 0;
+    pool.run(16, [&] (size_t) {
+        pool.run(16, [&calls] (size_t) { calls.fetch_add(1); });
+    });
+    EXPECT_EQ (calls.load(), 256);
+}
+
+TEST(WorkStealingPool, ConcurrentCallersAllComplete) {
+    WorkStealingPool pool(2);
+    std::atomic_size_t calls = 0;
+    std::vector<std::jthread> callers;
+    for (int caller = 0; caller < 4; ++caller)
+        callers.emplace_back([&] {
+            for (int loop = 0; loop < 100; ++loop) pool.run(50, [&calls] (size_t) { calls.fetch_add(1); });
+        });
+    callers.clear();
+    EXPECT_EQ (calls.load(), 4 * 100 * 50);
+}